@@ -0,0 +1,100 @@
+/*!
+  * \brief      Host benchmark of USE_AGG - messages per second against the number of records per frame
+  * \details    Small messages arrive at random on one hop and wait in the aggregated frame.
+  *             The frame goes out once it holds "records" messages or its flush timer ran out,
+  *             whichever comes first, and only while the transmitter is idle.
+  *             One record per frame is the plain firmware without aggregation.
+  *             Usage: ./agg_bench [message bytes] [flush bits] */
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "link.c"
+
+#define PREAMBLE_BITS   8
+#define CRC_BITS        32
+#define DLC_BITS        8
+/// Addresses of the frame and of every record (AGG_HEADER)
+#define HEADER_BYTES    2
+#define RECORD_BYTES    3
+#define LEGACY_PAYLOAD  251
+#define MESSAGES        20000
+
+typedef struct
+{
+    double delivered;   ///< Messages per second
+    double latency;     ///< Mean bit times from arrival to delivery
+} result_t;
+
+/// Single hop fed with "load" messages per bit time on average
+result_t run(const double load, const uint32_t records, const uint32_t length, const uint32_t flush)
+{
+    static uint64_t arrival[MESSAGES];
+    const uint32_t fit = (LEGACY_PAYLOAD - HEADER_BYTES) / (RECORD_BYTES + length);
+    const uint32_t limit = (records < fit) ? records : fit;
+    uint64_t now = 0, latency = 0;
+    uint32_t head = 0, tail = 0;
+
+    // Exponential gaps between arrivals
+    double t = 0.0;
+    for(uint32_t i=0; i<MESSAGES; i++)
+    {
+        double u = ((double)linkRandom() + 1.0) / 4294967297.0;
+        t += -log(u) / load;
+        arrival[i] = (uint64_t)t;
+    }
+
+    while(head < MESSAGES)
+    {
+        while((tail < MESSAGES) && (arrival[tail] <= now))
+            tail++;
+        uint32_t queued = tail - head;
+
+        // Idle transmitter - wait for the frame to fill or for the flush timer
+        if((queued == 0) || ((queued < limit) && ((now - arrival[head]) < flush)))
+        {
+            uint64_t next = (queued == 0) ? arrival[tail] : (arrival[head] + flush);
+            if((queued > 0) && (tail < MESSAGES) && (arrival[tail] < next))
+                next = arrival[tail];
+            now = (next > now) ? next : (now + 1);
+            continue;
+        }
+
+        uint32_t count = (queued < limit) ? queued : limit;
+        now += PREAMBLE_BITS + CRC_BITS + DLC_BITS + ((HEADER_BYTES + (count * (RECORD_BYTES + length))) * 8);
+        for(uint32_t i=0; i<count; i++)
+            latency += now - arrival[(head+i)];
+        head += count;
+    }
+
+    result_t result = { (MESSAGES * LINK_BITRATE) / now, (double)latency / MESSAGES };
+    return result;
+}
+
+int main(int argc, char** argv)
+{
+    const uint32_t length = (argc > 1) ? atoi(argv[1]) : 4;
+    const uint32_t flush = (argc > 2) ? atoi(argv[2]) : 64;
+    const uint32_t records[5] = { 1, 2, 4, 8, 16 };
+    const double loads[4] = { 0.5, 1.0, 2.0, 4.0 };
+
+    linkSeed(1);
+    printf("aggregation of %u-byte messages, flush after %u bits\n", length, flush);
+    printf("messages/s (mean latency in bit times) per offered load\n\n");
+    printf("%-8s", "RECORDS");
+    for(int l=0; l<4; l++)
+        printf("  %5.1f msg/s          ", loads[l] * LINK_BITRATE / 100.0);
+    printf("\n");
+
+    for(int r=0; r<5; r++)
+    {
+        printf("%-8u", records[r]);
+        for(int l=0; l<4; l++)
+        {
+            // Offered load in messages per 100 bit times
+            result_t result = run(loads[l] / 100.0, records[r], length, flush);
+            printf("  %7.2f (%10.1f)", result.delivered, result.latency);
+        }
+        printf("\n");
+    }
+    return 0;
+}
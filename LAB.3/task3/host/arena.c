@@ -0,0 +1,43 @@
+#pragma once
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "arena.h"
+
+void arenaInit(arena_t* arena, const size_t size)
+{
+    arena->base = malloc(size);
+    arena->size = size;
+    arena->used = 0;
+    if(!arena->base)
+    {
+        fprintf(stderr, "arena of %zu bytes\n", size);
+        exit(1);
+    }
+}
+
+void* arenaAlloc(arena_t* arena, const size_t bytes)
+{
+    size_t start = (arena->used + 15) & ~((size_t)15);
+    if((start + bytes) > arena->size)
+    {
+        fprintf(stderr, "arena full\n");
+        exit(1);
+    }
+    arena->used = start + bytes;
+    memset(&arena->base[start], 0, bytes);
+    return &arena->base[start];
+}
+
+void arenaReset(arena_t* arena)
+{
+    arena->used = 0;
+}
+
+void arenaFree(arena_t* arena)
+{
+    free(arena->base);
+    arena->base = 0;
+    arena->size = 0;
+    arena->used = 0;
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+/// Bump allocator - one per thread, emptied at once between two simulations
+typedef struct
+{
+    uint8_t* base;
+    size_t size;
+    size_t used;
+} arena_t;
+
+
+/*! \brief      Reserves the memory of an arena
+  * \param      arena   - Arena to be set up
+  * \param      size    - Bytes it can hand out between two arenaReset
+  * \return     void */
+void arenaInit(arena_t* arena, const size_t size);
+
+
+/*! \brief      Hands out zeroed memory, aligned for any type
+  * \param      arena   - Arena of the calling thread
+  * \param      bytes   - Size of the block
+  * \return     void* - Block, the program ends if the arena is used up */
+void* arenaAlloc(arena_t* arena, const size_t bytes);
+
+
+/*! \brief      Takes back every block of the arena at once
+  * \return     void */
+void arenaReset(arena_t* arena);
+
+
+/*! \brief      Gives the memory of the arena back to the system
+  * \return     void */
+void arenaFree(arena_t* arena);
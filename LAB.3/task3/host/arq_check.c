@@ -0,0 +1,134 @@
+/*!
+  * \brief      Checks the give-up path of the hop-by-hop ARQ in arq.c
+  * \details    Built from the firmware with the POSIX backend and USE_ARQ, one node plays both ends of a link:
+  *             the sender of the frames to NEXT_ID, whose answers come back from the harness, and the receiver
+  *             of the frames of PREV_ID, which the harness sends. No thread runs, the timer is "ticks" itself.
+  *             A frame given up must be followed by an ARQ_SYNC, the receiver must take the next frame after
+  *             it, and NACKs must count against ARQ_RETRIES like timeouts.
+  *             Usage: ./arq_check */
+#include <stdio.h>
+#include <stdlib.h>
+#include "../src/interrupt.c"
+
+#if !USE_ARQ
+#error "arq_check needs -DUSE_ARQ=1"
+#endif
+
+static uint32_t _failed;
+
+void expect(const int ok, const char* what)
+{
+    printf("%-6s%s\n", ok ? "OK" : "FAIL", what);
+    if(!ok)
+        _failed++;
+}
+
+/// Data frame of this node to NEXT_ID, stamped and kept by the ARQ like sendFrame does
+void sendData(frame_t* frame)
+{
+    clearFrame(frame);
+    SET_LENGTH(frame, (HDR_SIZE + 4));
+    frame->payload[HDR_DST] = NEXT_ID;
+    frame->payload[HDR_SRC] = MY_ID;
+    arqStamp(frame);
+}
+
+/// Control frame of another node to this one
+void control(frame_t* frame, const uint8_t src, const uint8_t type, const uint8_t seq)
+{
+    clearFrame(frame);
+    SET_LENGTH(frame, (HDR_SIZE + 2));
+    frame->payload[HDR_DST] = MY_ID;
+    frame->payload[HDR_SRC] = src;
+    frame->payload[HDR_LINK] = LINK_CONTROL;
+    frame->payload[HDR_SIZE] = type;
+    frame->payload[HDR_SIZE+1] = seq;
+}
+
+/// Data frame of the upstream neighbour with the given sequence number
+void upstream(frame_t* frame, const uint8_t seq)
+{
+    clearFrame(frame);
+    SET_LENGTH(frame, (HDR_SIZE + 4));
+    frame->payload[HDR_DST] = MY_ID;
+    frame->payload[HDR_SRC] = PREV_ID;
+    frame->payload[HDR_LINK] = seq;
+}
+
+/// Lets the retransmission timer run out, returns 1 if the oldest frame "seq" was sent again first
+uint8_t timeout(frame_t* frame, const uint8_t seq)
+{
+    ticks += (ARQ_TIMEOUT_BITS*BIT_TICKS) + 1;
+    uint8_t resent = arqPoll(frame) && !(frame->payload[HDR_LINK] & LINK_CONTROL)
+                     && (frame->payload[HDR_LINK] == seq);
+
+    // The rest of the window follows, the sync waits for the next poll
+    while(arqResending && arqPoll(frame))
+        ;
+    return resent;
+}
+
+void checkSender()
+{
+    frame_t frame;
+    sendData(&frame);
+    sendData(&frame);
+
+    // Frame 0 goes out ARQ_RETRIES more times, then it is given up and NEXT_ID is told to skip it
+    uint32_t resent = 0;
+    for(uint32_t i=0; i<ARQ_RETRIES; i++)
+        resent += timeout(&frame, 0);
+    expect(resent == ARQ_RETRIES, "timeouts resend the oldest frame ARQ_RETRIES times");
+    expect(!timeout(&frame, 0) && (stats.arqGiveUps == 1) && (arqBase == 1), "the next timeout gives it up");
+    expect(arqPoll(&frame) && (frame.payload[HDR_DST] == NEXT_ID) && (frame.payload[HDR_SIZE] == ARQ_SYNC)
+           && (frame.payload[HDR_SIZE+1] == 1), "an ARQ_SYNC of sequence number 1 goes to NEXT_ID");
+
+    // The downstream neighbour missed the sync and keeps asking for frame 0
+    control(&frame, NEXT_ID, ARQ_NACK, 0);
+    arqFilter(&frame);
+    expect(arqPoll(&frame) && (frame.payload[HDR_SIZE] == ARQ_SYNC) && (frame.payload[HDR_SIZE+1] == 1),
+           "a NACK of a given up frame repeats the sync");
+
+    // NACKs of frame 1 count as tries too, so it is given up instead of looping around the ring
+    uint32_t nacks = 0;
+    while((arqBase == 1) && (nacks < (4*ARQ_RETRIES)))
+    {
+        control(&frame, NEXT_ID, ARQ_NACK, 1);
+        arqFilter(&frame);
+        while(arqPoll(&frame))
+            ;
+        nacks++;
+    }
+    expect((nacks == (ARQ_RETRIES + 1)) && (stats.arqGiveUps == 2) && (arqBase == arqNext),
+           "NACKs give a frame up after ARQ_RETRIES");
+}
+
+void checkReceiver()
+{
+    frame_t frame;
+    arqExpect = 0;
+
+    upstream(&frame, 0);
+    expect(arqFilter(&frame) && (arqExpect == 1), "frame 0 of PREV_ID is taken");
+
+    // Frame 1 was given up upstream, so frame 2 looks like a gap until the sync arrives
+    upstream(&frame, 2);
+    expect(!arqFilter(&frame) && (arqReply == ARQ_NACK) && (arqReplySeq == 1), "frame 2 is a gap and NACKed");
+    control(&frame, PREV_ID, ARQ_SYNC, 2);
+    expect(!arqFilter(&frame) && (arqExpect == 2) && (arqReply == ARQ_NACK) && (arqReplySeq == 2),
+           "the sync moves the expected frame to 2 and asks for it");
+    upstream(&frame, 2);
+    expect(arqFilter(&frame) && (arqExpect == 3) && (arqReply == ARQ_ACK), "frame 2 is taken after the sync");
+
+    // A sync that arrives late must not move the receiver back
+    control(&frame, PREV_ID, ARQ_SYNC, 2);
+    expect(!arqFilter(&frame) && (arqExpect == 3), "a stale sync is ignored");
+}
+
+int main()
+{
+    checkSender();
+    checkReceiver();
+    printf("\n%s\n", _failed ? "ARQ CHECK FAILED" : "ARQ CHECK PASSED");
+    return _failed ? 1 : 0;
+}
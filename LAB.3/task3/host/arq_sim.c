@@ -0,0 +1,284 @@
+/*!
+  * \brief      Host simulation of the hop-by-hop ARQ of USE_ARQ on one link of the ring
+  * \details    The node sends data frames to its downstream neighbour, which answers every frame with an ACK or NACK.
+  *             Because the ring runs in one direction only, the answer travels through the other N-1 nodes.
+  *             The sender and receiver follow arq.c: go-back-N window, cumulative ACK, NACK on a broken crc,
+  *             retransmission timer, give-up after ARQ_RETRIES timeouts or NACKs and the ARQ_SYNC that follows it.
+  *             The first table has the link to itself, the node sends whenever the window lets it. The second one
+  *             puts the link into a ring where every link carries data and every node runs ARQ, for several ring
+  *             sizes. Each link then also carries the answers of N-1 nodes - all but the one of its own receiver -
+  *             so every data frame shares its link with N-1 control frames. The answer to a frame waits behind
+  *             half a data frame at every hop, as it would in the relay queue of USE_QUEUE; without the queue it
+  *             cuts off the frame on the wire instead, which this model leaves out. The frames are relays that
+  *             arrive once per data frame time: if the window is still full then, relayFrame drops them (DROP,
+  *             stats.arqDropped) - the round trip of the answers grows with the ring, the window of ARQ_WINDOW
+  *             frames does not. A node answers only the last frame it got before its transmitter was free again,
+  *             the answers are cumulative, so nothing is lost by that and the model sends one per frame.
+  *             Usage: ./arq_sim [ring size] [dlc] [frames] */
+#include <stdio.h>
+#include <stdlib.h>
+#include "link.c"
+#include "event.c"
+
+#define SEQ_MASK        0x7f
+#define RETRIES         4
+/// ARQ_WINDOW of arq.h
+#define WINDOW          2
+#define PREAMBLE_BITS   8
+#define HEADER_BITS     40
+/// Control frame - addresses, link byte, type and sequence number
+#define CONTROL_BITS    (PREAMBLE_BITS + HEADER_BITS + (5*8))
+/// Same rule as ARQ_TIMEOUT_BITS - two longest frames plus one control frame per node
+#define TIMEOUT_BITS    ((2*2040) + (ring*CONTROL_BITS))
+
+#define EVENT_DATA      1
+#define EVENT_CONTROL   2
+#define EVENT_SYNC      3
+#define ACK             1
+#define NACK            2
+
+/// Sends a frame of "bits" over "hops" links, returns 1 if no bit was flipped
+uint8_t survives(const uint32_t bits, const uint32_t hops, const double ber)
+{
+    for(uint32_t h=0; h<hops; h++)
+    {
+        for(uint32_t i=0; i<bits; i++)
+            if(linkError(ber)) return 0x00;
+    }
+    return 0x01;
+}
+
+/// Gives up the oldest frame and sends the sync to the downstream neighbour, one hop away
+void giveUp(uint8_t* base, const uint8_t next, uint8_t* resend, uint8_t* resending, uint8_t* tries,
+            const uint64_t now, const double ber)
+{
+    *base = ((*base + 1) & SEQ_MASK);
+    *tries = 0;
+    if(((*resend - *base) & SEQ_MASK) > ((next - *base) & SEQ_MASK))
+        *resend = *base;
+    if(*base == next)
+        *resending = 0;
+    event_t sync = { now + CONTROL_BITS, EVENT_SYNC, 0, *base, survives(CONTROL_BITS, 1, ber), 0 };
+    eventPush(sync);
+}
+
+typedef struct
+{
+    double goodput;
+    double resent;
+    double lost;
+    double dropped;
+    double control;
+} result_t;
+
+result_t simulate(const uint32_t ring, const uint32_t dlc, const uint32_t frames, const uint32_t window, const double ber,
+                  const uint8_t loaded)
+{
+    const uint32_t frameBits = PREAMBLE_BITS + HEADER_BITS + (dlc*8);
+    // The answers of the other nodes that cross the link for every data frame on it
+    const uint32_t controlBits = loaded ? ((ring-1) * CONTROL_BITS) : 0;
+    const uint32_t slotBits = frameBits + controlBits;
+    // The answer waits for the relay of the frame, then crosses the rest of the ring
+    const uint64_t answerDelay = frameBits + ((uint64_t)(ring-1) * (CONTROL_BITS + (loaded ? (frameBits / 2) : 0)));
+
+    uint8_t base = 0, next = 0, resend = 0, resending = 0, tries = 0;
+    uint8_t expect = 0;
+    uint64_t timer = 0, now = 0, offer = 0;
+    uint32_t sent = 0, delivered = 0, retransmits = 0, dropped = 0;
+
+    eventClear();
+    while((sent < frames) || (base != next))
+    {
+        // Events up to the moment the link becomes free
+        while(eventNext() <= now)
+        {
+            event_t e = eventPop();
+            if(e.type == EVENT_DATA)
+            {
+                event_t answer = { e.time + answerDelay, EVENT_CONTROL, 0, 0, 0, NACK };
+                if(e.ok)
+                {
+                    uint8_t behind = ((expect - e.seq) & SEQ_MASK);
+                    uint8_t ahead = ((e.seq - expect) & SEQ_MASK);
+                    if((behind > 0) && (behind <= window))
+                        answer.arg = ACK;
+                    else if((ahead > 0) && (ahead < window))
+                        answer.arg = NACK;
+                    else
+                    {
+                        expect = ((e.seq + 1) & SEQ_MASK);
+                        delivered++;
+                        answer.arg = ACK;
+                    }
+                }
+                answer.seq = expect;
+                answer.ok = survives(CONTROL_BITS, ring-1, ber);
+                eventPush(answer);
+            }
+            else if(e.type == EVENT_SYNC)
+            {
+                // Skips the given up frames and asks for the next one
+                if(e.ok && (((e.seq - expect) & SEQ_MASK) < (SEQ_MASK / 2)))
+                    expect = e.seq;
+                event_t answer = { e.time + ((uint64_t)(ring-1) * CONTROL_BITS), EVENT_CONTROL, 0, expect,
+                                   survives(CONTROL_BITS, ring-1, ber), NACK };
+                if(e.ok)
+                    eventPush(answer);
+            }
+            else if(e.ok)
+            {
+                uint8_t outstanding = ((next - base) & SEQ_MASK);
+                if((((e.seq - base) & SEQ_MASK) <= outstanding) && (e.seq != base))
+                {
+                    base = e.seq;
+                    tries = 0;
+                    timer = e.time;
+                }
+                outstanding = ((next - base) & SEQ_MASK);
+                if(((resend - base) & SEQ_MASK) > outstanding)
+                    resend = base;
+                if(base == next)
+                    resending = 0;
+                if((e.arg == NACK) && (((e.seq - base) & SEQ_MASK) > outstanding))
+                {
+                    // The sync got lost, the receiver still waits for a given up frame
+                    event_t sync = { e.time + CONTROL_BITS, EVENT_SYNC, 0, base, survives(CONTROL_BITS, 1, ber), 0 };
+                    eventPush(sync);
+                }
+                else if((e.arg == NACK) && (base != next))
+                {
+                    if((++tries) > RETRIES)
+                        giveUp(&base, next, &resend, &resending, &tries, e.time, ber);
+                    if(base != next)
+                    {
+                        resend = base;
+                        resending = 1;
+                    }
+                }
+            }
+        }
+
+        uint8_t outstanding = ((next - base) & SEQ_MASK);
+        if((!resending) && (outstanding > 0) && ((now - timer) > TIMEOUT_BITS))
+        {
+            timer = now;
+            if((++tries) > RETRIES)
+            {
+                giveUp(&base, next, &resend, &resending, &tries, now, ber);
+                continue;
+            }
+            resend = base;
+            resending = 1;
+        }
+
+        // A relay that finds the window full is gone, the next one comes a data frame time later
+        if(loaded && (!resending) && (outstanding >= window) && (sent < frames) && (offer <= now))
+        {
+            sent++;
+            dropped++;
+            offer += slotBits;
+            continue;
+        }
+
+        uint8_t seq;
+        if(resending)
+        {
+            seq = resend;
+            resend = ((resend + 1) & SEQ_MASK);
+            if(resend == next)
+                resending = 0;
+            timer = now;
+            retransmits++;
+        }
+        else if((outstanding < window) && (sent < frames) && (offer <= now))
+        {
+            seq = next;
+            next = ((next + 1) & SEQ_MASK);
+            if(outstanding == 0)
+            {
+                tries = 0;
+                timer = now;
+            }
+            sent++;
+            if(loaded)
+                offer += slotBits;
+        }
+        else
+        {
+            // Idle until the next answer, relay or the retransmission timer
+            uint64_t wake = timer + TIMEOUT_BITS + 1;
+            if(eventNext() < wake)
+                wake = eventNext();
+            if(loaded && (sent < frames) && (offer > now) && (offer < wake))
+                wake = offer;
+            now = (wake > now) ? wake : (now + 1);
+            continue;
+        }
+
+        event_t data = { now + frameBits, EVENT_DATA, 0, seq, survives(frameBits, 1, ber), 0 };
+        eventPush(data);
+        now += slotBits;
+    }
+
+    result_t result;
+    result.goodput = ((double)delivered * dlc * 8) / (double)now;
+    result.resent = (double)retransmits / frames;
+    result.lost = (100.0 * (frames - delivered)) / frames;
+    result.dropped = (100.0 * dropped) / frames;
+    result.control = (100.0 * controlBits) / slotBits;
+    return result;
+}
+
+int main(int argc, char** argv)
+{
+    const uint32_t ring = (argc > 1) ? (uint32_t)atoi(argv[1]) : 4;
+    const uint32_t dlc = (argc > 2) ? (uint32_t)atoi(argv[2]) : 64;
+    const uint32_t frames = (argc > 3) ? (uint32_t)atoi(argv[3]) : 5000;
+    const double bers[6] = { 0.0, 1e-5, 1e-4, 1e-3, 3e-3, 1e-2 };
+    const uint32_t windows[3] = { 1, 2, 4 };
+
+    linkSeed(1);
+    printf("ring %u nodes, dlc %u, %u frames - goodput in payload bits per bit time\n\n", ring, dlc, frames);
+    printf("%-8s %12s", "BER", "NO ARQ");
+    for(int w=0; w<3; w++)
+        printf("   W=%u GOODPUT RESENT LOST", windows[w]);
+    printf("\n");
+
+    const uint32_t frameBits = PREAMBLE_BITS + HEADER_BITS + (dlc*8);
+    for(int b=0; b<6; b++)
+    {
+        // Without ARQ the link sends back-to-back and a broken frame is simply gone
+        uint32_t ok = 0;
+        for(uint32_t f=0; f<frames; f++)
+            ok += survives(frameBits, 1, bers[b]);
+        printf("%-8g %12.3f", bers[b], ((double)ok * dlc * 8) / ((double)frames * frameBits));
+
+        for(int w=0; w<3; w++)
+        {
+            result_t r = simulate(ring, dlc, frames, windows[w], bers[b], 0);
+            printf("   %11.3f %6.2f %3.0f%%", r.goodput, r.resent, r.lost);
+        }
+        printf("\n");
+    }
+
+    // Every link of the ring loaded, with the window of arq.h
+    const uint32_t rings[5] = { 4, 8, 16, 32, 64 };
+    const double loadBers[3] = { 0.0, 1e-4, 1e-3 };
+    printf("\nloaded ring, W=%u, relays arrive once per data frame time - CONTROL is the share of every link the answers take\n\n", WINDOW);
+    printf("%-6s %8s", "NODES", "CONTROL");
+    for(int b=0; b<3; b++)
+        printf("   BER %-6g GOODPUT RESENT LOST DROP", loadBers[b]);
+    printf("\n");
+    for(int n=0; n<5; n++)
+    {
+        result_t r = simulate(rings[n], dlc, frames, WINDOW, 0.0, 1);
+        printf("%-6u %7.0f%%", rings[n], r.control);
+        for(int b=0; b<3; b++)
+        {
+            r = simulate(rings[n], dlc, frames, WINDOW, loadBers[b], 1);
+            printf("   %18.3f %6.2f %3.0f%% %3.0f%%", r.goodput, r.resent, r.lost, r.dropped);
+        }
+        printf("\n");
+    }
+    return 0;
+}
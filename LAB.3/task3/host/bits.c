@@ -0,0 +1,47 @@
+#pragma once
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bits.h"
+
+uint32_t bitsRead(const char* path, uint8_t* bits, uint64_t* blocks)
+{
+    FILE* in = fopen(path, "r");
+    if(!in)
+        return 0;
+    char line[256];
+    uint32_t count = 0;
+    *blocks = 0;
+    memset(bits, 0, (BITS_MAX / 8));
+    while(fgets(line, sizeof(line), in))
+    {
+        if(line[0] == '#')
+        {
+            if(!strncmp(line, "# blocks ", 9))
+                *blocks = strtoull(&line[9], 0, 10);
+            continue;
+        }
+        for(char* c=line; *c && (count < BITS_MAX); c++)
+        {
+            if((*c != '0') && (*c != '1'))
+                continue;
+            if(*c == '1')
+                bits[(count / 8)] |= (0x80 >> (count % 8));
+            count++;
+        }
+    }
+    fclose(in);
+    return count;
+}
+
+int bitsWrite(const char* path, const uint8_t* bits, const uint32_t count, const char* comment, const uint64_t blocks)
+{
+    FILE* out = fopen(path, "w");
+    if(!out)
+        return 0;
+    fprintf(out, "# blocks %llu\n# %s\n", (unsigned long long)blocks, comment);
+    for(uint32_t i=0; i<count; i++)
+        fprintf(out, "%c%s", BITS_GET(bits, i) ? '1' : '0', (((i % 64) == 63) || ((i + 1) == count)) ? "\n" : "");
+    fclose(out);
+    return 1;
+}
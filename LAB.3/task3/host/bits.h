@@ -0,0 +1,31 @@
+#pragma once
+#include <stdint.h>
+
+/* Bit Streams
+ * Regression inputs of the receiver - the data bit of every clock edge of the upstream link, in order,
+ * written as lines of '0' and '1'. Lines starting with '#' are comments, "# blocks <n>" records the cost
+ * of the worst interrupt the stream caused when it was found. */
+
+/// Longest stream, a frame of the largest payload with Hamming coding and some bits around it
+#define BITS_MAX        4096
+
+/// Bit pos of a stream, MSB first like readBit
+#define BITS_GET(bits, pos)     (((bits)[(pos) / 8] >> (7 - ((pos) % 8))) & 0x01)
+
+
+/*! \brief      Reads a stream
+  * \param      path    - File of '0' and '1'
+  * \param      bits    - Buffer of BITS_MAX/8 bytes
+  * \param      blocks  - Recorded cost, 0 if the file has none
+  * \return     Number of bits, 0 if the file cannot be read */
+uint32_t bitsRead(const char* path, uint8_t* bits, uint64_t* blocks);
+
+
+/*! \brief      Writes a stream
+  * \param      path    - File to be written
+  * \param      bits    - Stream
+  * \param      count   - Number of bits
+  * \param      comment - Line of the header after "# blocks", without '#'
+  * \param      blocks  - Cost of its worst interrupt
+  * \return     1 on success, 0 otherwise */
+int bitsWrite(const char* path, const uint8_t* bits, const uint32_t count, const char* comment, const uint64_t blocks);
@@ -0,0 +1,343 @@
+#pragma once
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "capacity.h"
+#include "arena.c"
+#include "link.c"
+#include "event.c"
+
+/// checkAddress of the firmware, with MY_ID being the node the frame just reached
+#define HAL_POSIX       1
+#define RING_SIZE       CAPACITY_MAX_NODES
+#define MY_ID           _simId
+__thread uint8_t _simId = 1;
+#include "../src/frame.h"
+#include "../src/layer3.c"
+
+/// The serial port is not used here
+void uart_init(unsigned long ubrr) {}
+void uart_transmit(unsigned char data) {}
+unsigned char uart_receive() { return 0; }
+uint8_t uart_available() { return 0; }
+void uart_changeLine() {}
+
+#define PREAMBLE_BITS   8
+
+/// Bits a cut-through node waits for - up to the source address
+#define CUT_BITS        (PREAMBLE_BITS + 32 + (8 * DLC_SIZE) + 16)
+
+#define EVENT_ARRIVAL   1
+#define EVENT_HEADER    2
+#define EVENT_DONE      3
+
+#define NONE            0xffffffff
+
+/// Frame in flight - 12 bytes, only its addresses go through checkAddress
+typedef struct
+{
+    uint32_t born;
+    uint8_t dst, src;
+    uint8_t broken;     ///< 1 once a hop flipped a bit
+    uint32_t next;      ///< Free list
+} sim_frame_t;
+
+/// Node - two small rings of frame numbers and the frame on its transmitter
+typedef struct
+{
+    uint32_t relay[CAPACITY_MAX_QUEUE];
+    uint32_t own[CAPACITY_MAX_QUEUE];
+    uint8_t relayHead, relayCount, ownHead, ownCount;
+    uint32_t wire;
+    uint8_t passed;     ///< 1 if the next node already relays the frame on the wire
+    uint64_t busy;
+} node_t;
+
+typedef struct
+{
+    uint64_t delivered, broadcasts, crcFailed, dropped, refused;
+} result_t;
+
+/// Latency - log-linear histogram, 32 steps per power of two, so a percentile is off by 3 % at most
+#define HIST_STEPS      32
+#define HIST_SIZE       (64 * HIST_STEPS)
+
+/// State of the run of one thread - the arrays come from its arena
+static __thread node_t* _nodes;
+static __thread sim_frame_t* _frames;
+static __thread uint32_t _free;
+static __thread uint32_t* _hist;
+static __thread uint64_t _histCount;
+
+static __thread uint32_t _ring, _queue, _frameBits;
+static __thread uint8_t _cut;
+static __thread double _broadcast, _hopError;
+static __thread uint64_t _duration;
+static __thread result_t _r;
+
+static void histAdd(const uint64_t value)
+{
+    uint32_t bucket = (uint32_t)value;
+    if(value >= (2 * HIST_STEPS))
+    {
+        // The top 6 bits pick the step, the position of the top bit the power of two
+        uint32_t shift = 63 - __builtin_clzll(value) - 5;
+        bucket = ((shift + 1) * HIST_STEPS) + (uint32_t)(value >> shift);
+    }
+    _hist[bucket]++;
+    _histCount++;
+}
+
+/// Upper end of the bucket holding the given share of the samples
+static uint64_t histPercentile(const double share)
+{
+    uint64_t rank = (uint64_t)ceil(share * _histCount);
+    uint64_t seen = 0;
+    for(uint32_t b=0; b<HIST_SIZE; b++)
+    {
+        seen += _hist[b];
+        if(seen && (seen >= rank))
+        {
+            if(b < (2 * HIST_STEPS))
+                return b;
+            uint32_t shift = (b / HIST_STEPS) - 2;
+            return ((uint64_t)((b % HIST_STEPS) + HIST_STEPS + 1) << shift) - 1;
+        }
+    }
+    return 0;
+}
+
+static uint32_t frameNew()
+{
+    uint32_t f = _free;
+    _free = _frames[f].next;
+    return f;
+}
+
+static void frameFree(const uint32_t f)
+{
+    _frames[f].next = _free;
+    _free = f;
+}
+
+/// Runs checkAddress of the firmware as node n, which has the ID n+1
+static uint8_t check(const uint32_t n, const uint32_t f)
+{
+    frame_t frame;
+    memset(frame.payload, 0, HDR_SIZE);
+    frame.payload[HDR_DST] = _frames[f].dst;
+    frame.payload[HDR_SRC] = _frames[f].src;
+    _simId = (uint8_t)(n + 1);
+    return checkAddress(&frame);
+}
+
+static void transmit(const uint32_t n, const uint32_t f, const uint64_t now)
+{
+    _nodes[n].wire = f;
+    _nodes[n].busy += _frameBits;
+    _nodes[n].passed = 0;
+    event_t e = { .time = now + _frameBits, .type = EVENT_DONE, .node = (uint8_t)n };
+    eventPush(e);
+    if(_cut)
+    {
+        e.time = now + CUT_BITS;
+        e.type = EVENT_HEADER;
+        eventPush(e);
+    }
+}
+
+/// Starts the next frame of an idle node, relayed frames first
+static void start(const uint32_t n, const uint64_t now)
+{
+    node_t* node = &_nodes[n];
+    if(node->wire != NONE)
+        return;
+    if(node->relayCount)
+    {
+        uint32_t f = node->relay[node->relayHead];
+        node->relayHead = (node->relayHead + 1) % CAPACITY_MAX_QUEUE;
+        node->relayCount--;
+        transmit(n, f, now);
+    }
+    else if(node->ownCount)
+    {
+        uint32_t f = node->own[node->ownHead];
+        node->ownHead = (node->ownHead + 1) % CAPACITY_MAX_QUEUE;
+        node->ownCount--;
+        transmit(n, f, now);
+    }
+}
+
+/// Poisson arrivals - the next frame of node n after an exponential gap
+static void nextArrival(const uint32_t n, const uint64_t now, const double rate)
+{
+    double u = ((double)linkRandom() + 1.0) / 4294967297.0;
+    event_t e = { .time = now + 1 + (uint64_t)(-log(u) / rate), .type = EVENT_ARRIVAL, .node = (uint8_t)n };
+    eventPush(e);
+}
+
+static void arrival(const uint32_t n, const uint64_t now, const double rate)
+{
+    node_t* node = &_nodes[n];
+    if(node->ownCount >= _queue)
+        _r.refused++;
+    else
+    {
+        uint32_t f = frameNew();
+        _frames[f] = (sim_frame_t){ .born = (uint32_t)now, .src = (uint8_t)(n + 1), .broken = 0 };
+        if((linkRandom() / 4294967296.0) < _broadcast)
+            _frames[f].dst = BROADCAST_ID;
+        else
+            _frames[f].dst = (uint8_t)(((n + 1 + (linkRandom() % (_ring - 1))) % _ring) + 1);
+        node->own[((node->ownHead + node->ownCount) % CAPACITY_MAX_QUEUE)] = f;
+        node->ownCount++;
+    }
+    nextArrival(n, now, rate);
+}
+
+static void relay(const uint32_t n, const uint32_t f)
+{
+    node_t* node = &_nodes[n];
+    if(node->relayCount >= _queue)
+    {
+        _r.dropped++;
+        frameFree(f);
+        return;
+    }
+    node->relay[((node->relayHead + node->relayCount) % CAPACITY_MAX_QUEUE)] = f;
+    node->relayCount++;
+}
+
+/// The addresses of the frame on the wire of node n reached node "next" - an idle node relays it at once
+static void header(const uint32_t n, const uint64_t now)
+{
+    uint32_t f = _nodes[n].wire;
+    uint32_t next = (n + 1) % _ring;
+    uint8_t result = check(next, f);
+    if(((result == OTHER_MSG) || (result == BROADCAST)) && (_nodes[next].wire == NONE) && !_nodes[next].relayCount)
+    {
+        transmit(next, f, now);
+        _nodes[n].passed = 1;
+    }
+}
+
+/// The last bit of the frame on the wire of node n reached node "next"
+static void done(const uint32_t n, const uint64_t now)
+{
+    uint32_t f = _nodes[n].wire;
+    uint32_t next = (n + 1) % _ring;
+    uint8_t passed = _nodes[n].passed;
+    _nodes[n].wire = NONE;
+
+    if((_hopError > 0.0) && ((linkRandom() / 4294967296.0) < _hopError))
+        _frames[f].broken = 1;
+
+    uint8_t result = check(next, f);
+    uint8_t deliver = ((result == MY_MSG) || (result == BROADCAST) || (result == MY_BROADCAST));
+    if(_frames[f].broken && (deliver || !passed))
+    {
+        // crc fails - a frame a cut-through node already passed on keeps going
+        _r.crcFailed++;
+        if(!passed)
+        {
+            frameFree(f);
+            return;
+        }
+        deliver = 0;
+    }
+
+    if(deliver && (result != BROADCAST))
+    {
+        histAdd(now - _frames[f].born);
+        if(result == MY_BROADCAST)
+            _r.broadcasts++;
+        else
+            _r.delivered++;
+    }
+
+    if((result == OTHER_MSG) || (result == BROADCAST))
+    {
+        if(!passed)
+            relay(next, f);
+    }
+    else if(!passed)
+        frameFree(f);
+}
+
+/// "load" is the expected busy share of every link, frames go half way round the ring on average
+static result_t run(const double load)
+{
+    double hops = (_broadcast * _ring) + ((1.0 - _broadcast) * (_ring / 2.0));
+    const double rate = load / (_frameBits * hops);
+    _r = (result_t){ 0, 0, 0, 0, 0 };
+    _histCount = 0;
+
+    uint32_t frames = _ring * ((2 * _queue) + 4);
+    _free = 0;
+    for(uint32_t f=0; f<frames; f++)
+        _frames[f].next = f + 1;
+
+    eventClear();
+    for(uint32_t n=0; n<_ring; n++)
+    {
+        _nodes[n] = (node_t){ .relayCount = 0, .ownCount = 0, .wire = NONE, .passed = 0, .busy = 0 };
+        nextArrival(n, 0, rate);
+    }
+
+    while(eventCount() && (eventNext() < _duration))
+    {
+        event_t e = eventPop();
+        uint32_t next = (e.node + 1) % _ring;
+        if(e.type == EVENT_ARRIVAL)
+            arrival(e.node, e.time, rate);
+        else if(e.type == EVENT_HEADER)
+        {
+            header(e.node, e.time);
+            continue;
+        }
+        else
+        {
+            done(e.node, e.time);
+            start(next, e.time);
+        }
+        start(e.node, e.time);
+    }
+    return _r;
+}
+
+capacity_result_t capacityRun(const capacity_params_t* params, arena_t* arena)
+{
+    arenaReset(arena);
+    _ring = params->nodes;
+    _queue = params->queue;
+    _cut = params->cut;
+    _broadcast = params->broadcast;
+    _frameBits = PREAMBLE_BITS + 32 + (8 * DLC_SIZE) + (8 * (HDR_SIZE + params->payload));
+    _hopError = 1.0 - pow(1.0 - params->ber, _frameBits);
+    _duration = (uint64_t)(params->hours * 3600.0 * params->bitrate);
+    _nodes = arenaAlloc(arena, sizeof(node_t) * _ring);
+    _frames = arenaAlloc(arena, sizeof(sim_frame_t) * _ring * ((2 * _queue) + 4));
+    _hist = arenaAlloc(arena, sizeof(uint32_t) * HIST_SIZE);
+    linkSeed(params->seed);
+
+    result_t r = run(params->load);
+    capacity_result_t c = { r.delivered, r.broadcasts, r.crcFailed, r.dropped, r.refused };
+    c.goodput = ((r.delivered + r.broadcasts) * params->payload * 8.0) / (_duration / params->bitrate);
+    c.p50 = histPercentile(0.50) / params->bitrate;
+    c.p90 = histPercentile(0.90) / params->bitrate;
+    c.p99 = histPercentile(0.99) / params->bitrate;
+    c.p999 = histPercentile(0.999) / params->bitrate;
+    for(uint32_t n=0; n<_ring; n++)
+    {
+        double u = capacityUtil(n);
+        c.utilAvg += u / _ring;
+        c.utilMax = (u > c.utilMax) ? u : c.utilMax;
+    }
+    return c;
+}
+
+double capacityUtil(const uint32_t n)
+{
+    return (double)_nodes[n].busy / _duration;
+}
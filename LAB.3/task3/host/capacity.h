@@ -0,0 +1,46 @@
+#pragma once
+#include <stdint.h>
+#include "arena.h"
+
+/// Largest ring and relay or local queue of one node
+#define CAPACITY_MAX_NODES      255
+#define CAPACITY_MAX_QUEUE      64
+
+/// Bytes an arena needs for one simulation of the largest ring
+#define CAPACITY_ARENA_SIZE     (1024 * 1024)
+
+/// One scenario of the discrete-event simulation of a ring
+typedef struct
+{
+    uint32_t nodes;
+    uint32_t payload;       ///< Bytes behind the header of every frame
+    uint32_t queue;         ///< Relayed and own frames a node holds, each
+    uint8_t cut;            ///< 1 for cut-through, 0 for store-and-forward like the firmware
+    double bitrate;         ///< Bits per second of a link, LINK_BITRATE for the ATMega
+    double ber;
+    double load;            ///< Expected busy share of every link
+    double broadcast;       ///< Share of the frames sent to BROADCAST_ID
+    double hours;
+    uint64_t seed;
+} capacity_params_t;
+
+typedef struct
+{
+    uint64_t delivered, broadcasts, crcFailed, dropped, refused;
+    double goodput;                 ///< Payload of the frames that arrived in bit/s, a broadcast counting once
+    double p50, p90, p99, p999;     ///< Latency in seconds, for a broadcast up to its return
+    double utilAvg, utilMax;        ///< Busy share of the transmitters
+} capacity_result_t;
+
+
+/*! \brief      Simulates one scenario, several threads may do so at the same time
+  * \param      params  - Scenario
+  * \param      arena   - Arena of the calling thread, which holds the nodes, frames and histogram of the run
+  * \return     capacity_result_t - Outcome of the scenario */
+capacity_result_t capacityRun(const capacity_params_t* params, arena_t* arena);
+
+
+/*! \brief      Busy share of one transmitter in the last run of the calling thread
+  * \param      n       - Node, 0 for the node with ID 1
+  * \return     double */
+double capacityUtil(const uint32_t n);
@@ -0,0 +1,84 @@
+/*!
+  * \brief      Discrete-event simulation of large RaspNet rings for capacity planning
+  * \details    Every node gets frames of its own at random (Poisson) to random other nodes, a share of them as broadcasts.
+  *             Each hop decides with checkAddress of src/layer3.c, run as the receiving node, whether the frame is
+  *             delivered, relayed or taken off the ring, and its bits follow the frame format of src/frame.h.
+  *             Relayed frames go first at every node, each node holds "queue" relayed and "queue" own frames
+  *             and drops anything beyond that. A hop with bit errors fails the crc of the receiving node.
+  *             Store-and-forward relays a frame once all of it arrived and its crc is checked, like the firmware.
+  *             Cut-through starts relaying an idle node once the addresses arrived, so a broken frame goes on
+  *             until its crc fails at the destination, and a busy node falls back to store-and-forward.
+  *             OFFERED is the expected load of every link, GOODPUT the payload in bit/s of the frames that arrived,
+  *             a broadcast counting once,
+  *             latency runs from the moment a frame is made to its delivery, for a broadcast to its return,
+  *             UTIL is the busy share of the transmitters.
+  *             The simulation itself is capacity.c, which the sweep driver runs for whole parameter grids.
+  *             Usage: ./capacity_sim [nodes] [hours] [queue] [bit error rate] [cut-through 1/0] [broadcast share]
+  *             Without arguments it runs 50, 200 and 255 nodes, both ways. With a ring size it also lists
+  *             the utilisation of every node at the highest load. */
+#include <stdio.h>
+#include <stdlib.h>
+#include "capacity.c"
+
+void report(capacity_params_t* p, arena_t* arena)
+{
+    capacity_result_t r = capacityRun(p, arena);
+    printf("%-6u%-5s%8.2f%10.1f%9.1f%9.1f%9.1f%9.1f%9llu%9llu%9llu%7.2f%7.2f\n", p->nodes, p->cut ? "CT" : "SF", p->load,
+           r.goodput, r.p50, r.p90, r.p99, r.p999,
+           (unsigned long long)r.crcFailed, (unsigned long long)r.dropped, (unsigned long long)r.refused,
+           r.utilAvg, r.utilMax);
+}
+
+int main(int argc, char** argv)
+{
+    const double loads[6] = { 0.1, 0.3, 0.5, 0.7, 0.9, 1.0 };
+    const uint32_t rings[3] = { 50, 200, 255 };
+    capacity_params_t p = { .payload = 32, .bitrate = LINK_BITRATE, .seed = 1 };
+    uint32_t ring = (argc > 1) ? atoi(argv[1]) : 0;
+    p.hours = (argc > 2) ? atof(argv[2]) : 1.0;
+    p.queue = (argc > 3) ? atoi(argv[3]) : 4;
+    p.ber = (argc > 4) ? atof(argv[4]) : 0.0;
+    int cut = (argc > 5) ? atoi(argv[5]) : -1;
+    p.broadcast = (argc > 6) ? atof(argv[6]) : 0.0;
+
+    if((ring == 1) || (ring > CAPACITY_MAX_NODES) || (p.queue < 1) || (p.queue > CAPACITY_MAX_QUEUE))
+    {
+        fprintf(stderr, "ring size 2 to %u, queue 1 to %u\n", CAPACITY_MAX_NODES, CAPACITY_MAX_QUEUE);
+        return 1;
+    }
+    arena_t arena;
+    arenaInit(&arena, CAPACITY_ARENA_SIZE);
+
+    printf("%.2f hours, %u bits per frame, queue %u, bit error rate %g, broadcast share %.2f\n\n",
+           p.hours, PREAMBLE_BITS + 32 + (8 * DLC_SIZE) + (8 * (HDR_SIZE + p.payload)), p.queue, p.ber, p.broadcast);
+    printf("%-6s%-5s%8s%10s%9s%9s%9s%9s%9s%9s%9s%7s%7s\n", "NODES", "MODE", "OFFERED", "GOODPUT",
+           "P50 s", "P90 s", "P99 s", "P99.9 s", "CRC", "DROPPED", "REFUSED", "UTIL", "MAX");
+
+    for(uint32_t i=0; i<3; i++)
+    {
+        p.nodes = ring ? ring : rings[i];
+        for(uint8_t c=0; c<2; c++)
+        {
+            if((cut >= 0) && (c != cut))
+                continue;
+            p.cut = c;
+            for(uint32_t l=0; l<6; l++)
+            {
+                p.load = loads[l];
+                report(&p, &arena);
+            }
+        }
+        if(ring)
+            break;
+    }
+
+    if(ring)
+    {
+        printf("\nutilisation per node at offered load %.2f\n", loads[5]);
+        for(uint32_t n=0; n<p.nodes; n++)
+            printf("%3u %.3f%s", n + 1, capacityUtil(n), ((n % 8) == 7) ? "\n" : "   ");
+        printf("\n");
+    }
+    arenaFree(&arena);
+    return 0;
+}
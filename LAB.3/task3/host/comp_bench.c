@@ -0,0 +1,116 @@
+/*!
+  * \brief      Host benchmark of the payload compression of USE_COMP
+  * \details    Compresses every line of a traffic file as one payload, like a console or telemetry send would.
+  *             Without a file it takes a built-in set of synthetic lines, written after the console and telemetry
+  *             output but not captured from a ring - its ratio says little about real traffic.
+  *             Payloads that do not shrink go out as they are, so the ratio never drops below 1. Decoding only
+  *             runs on the payloads that did shrink, so its cost is per byte those restored.
+  *             Cycles come from the time stamp counter on x86, elsewhere the column holds nanoseconds.
+  *             Usage: ./comp_bench [traffic file] */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "link.c"
+#include "../src/compress.c"
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define COUNTER()   __rdtsc()
+#else
+#define COUNTER()   linkNow()
+#endif
+
+#define PAYLOAD     251
+#define ROUNDS      200
+
+/// Synthetic lines in the style of the console and telemetry output, not a capture
+const char* _synthetic[] =
+{
+    "RECEIVE", "CRC OK", "MESSAGE TO ME", "BROADCAST", "TURN BACK",
+    "FROM 9 PORT 1 : test", "FROM 4 PORT 2 : test",
+    "T=23.5C H=41% V=3.31 I=0.012 NODE=15 UP=000123",
+    "T=23.6C H=41% V=3.31 I=0.013 NODE=15 UP=000124",
+    "T=23.6C H=42% V=3.30 I=0.012 NODE=15 UP=000125",
+    "ERR RX TIMEOUT ERR RX TIMEOUT ERR RX TIMEOUT",
+    "00000000000000000000000000000000000000000000000000000000",
+    "LOG 2026-10-19 12:00:01 node 15 link up, neighbour 4 jumbo 384",
+    "LOG 2026-10-19 12:00:02 node 15 link up, neighbour 4 jumbo 384",
+    "LOG 2026-10-19 12:00:03 node 15 ring size 8, ttl 8, arq window 2",
+    "the quick brown fox jumps over the lazy dog, the quick brown fox jumps again",
+    "ok",
+    "\x01\x02\xff\xfe\x80\x81 binary sensor block \x90\x91\x92",
+};
+
+int main(int argc, char** argv)
+{
+    char lines[256][PAYLOAD];
+    uint16_t lengths[256];
+    uint32_t count = 0;
+
+    if(argc > 1)
+    {
+        FILE* file = fopen(argv[1], "r");
+        if(!file)
+        {
+            perror(argv[1]);
+            return 1;
+        }
+        while((count < 256) && fgets(lines[count], PAYLOAD, file))
+        {
+            lengths[count] = strlen(lines[count]);
+            if(lengths[count] > 0)
+                count++;
+        }
+        fclose(file);
+    }
+    else
+    {
+        for(count=0; count<(sizeof(_synthetic) / sizeof(_synthetic[0])); count++)
+        {
+            lengths[count] = strlen(_synthetic[count]);
+            memcpy(lines[count], _synthetic[count], lengths[count]);
+        }
+    }
+
+    uint64_t plain = 0, wire = 0, decoded = 0, encodeCost = 0, decodeCost = 0, skipped = 0;
+    for(uint32_t i=0; i<count; i++)
+    {
+        uint8_t packed[PAYLOAD], restored[PAYLOAD];
+        uint16_t size = 0, back = 0;
+
+        uint64_t start = COUNTER();
+        for(uint32_t r=0; r<ROUNDS; r++)
+            size = compEncode((const uint8_t*)lines[i], lengths[i], packed, lengths[i]);
+        encodeCost += COUNTER() - start;
+
+        if(size == 0)
+        {
+            skipped++;
+            size = lengths[i];
+        }
+        else
+        {
+            start = COUNTER();
+            for(uint32_t r=0; r<ROUNDS; r++)
+                back = compDecode(packed, size, restored, PAYLOAD);
+            decodeCost += COUNTER() - start;
+            if((back != lengths[i]) || memcmp(restored, lines[i], back))
+            {
+                printf("line %u does not survive the round trip\n", i);
+                return 1;
+            }
+            decoded += back;
+        }
+        plain += lengths[i];
+        wire += size;
+    }
+
+    printf("payload compression of %s, %u payloads, %u skipped as incompressible\n\n",
+           (argc > 1) ? argv[1] : "synthetic lines", count, (uint32_t)skipped);
+    printf("%-20s%llu\n", "PLAIN BYTES", (unsigned long long)plain);
+    printf("%-20s%llu\n", "WIRE BYTES", (unsigned long long)wire);
+    printf("%-20s%.3f\n", "RATIO", (double)plain / wire);
+    printf("%-20s%.1f\n", "ENCODE CYCLES/BYTE", (double)encodeCost / ROUNDS / plain);
+    printf("%-20s%llu\n", "DECODED BYTES", (unsigned long long)decoded);
+    printf("%-20s%.1f\n", "DECODE CYCLES/BYTE", decoded ? ((double)decodeCost / ROUNDS / decoded) : 0.0);
+    return 0;
+}
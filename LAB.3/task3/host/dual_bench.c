@@ -0,0 +1,72 @@
+/*!
+  * \brief      Host benchmark of USE_DUAL - average hops per frame on one ring against the dual ring
+  * \details    Random nodes send to random destinations. A destination learns the direction back to the sender
+  *             from the hop count like dualLearn does, so the dual ring starts like the single one and
+  *             approaches the shorter arc once the nodes have heard from each other.
+  *             A ring of N nodes has N*(N-1) sender and destination pairs, so a run sends that many times the
+  *             given frames per pair. DUAL WARM covers the second half of them, LEARNED is the share of pairs
+  *             whose sender had already heard from its destination when that half began.
+  *             Usage: ./dual_bench [frames per pair] */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "link.c"
+
+#define MAX_NODES   255
+
+/// reverse[a][b] - node a sends to node b against the first ring, as in the direction cache
+static uint8_t reverse[MAX_NODES][MAX_NODES];
+/// heard[a][b] - node a got a frame of node b and learned its direction
+static uint8_t heard[MAX_NODES][MAX_NODES];
+
+/// Learns like dualLearn - "links" crossed by a frame of src that arrived at dst
+void learn(const uint32_t n, const uint32_t dst, const uint32_t src, const uint32_t links, const uint8_t back)
+{
+    uint32_t forward = back ? links : (n - links);
+    reverse[dst][src] = (forward > (n - forward));
+    heard[dst][src] = 1;
+}
+
+int main(int argc, char** argv)
+{
+    const uint32_t perPair = (argc > 1) ? atoi(argv[1]) : 16;
+    const uint32_t sizes[6] = { 4, 8, 16, 32, 64, 255 };
+
+    linkSeed(1);
+    printf("average hops per frame, %u frames per sender and destination pair\n\n", perPair);
+    printf("%-8s%12s%12s%12s%12s%12s%12s\n", "NODES", "FRAMES", "SINGLE", "DUAL", "DUAL WARM", "LEARNED", "N/4");
+
+    for(int s=0; s<6; s++)
+    {
+        const uint32_t n = sizes[s];
+        const uint64_t frames = (uint64_t)perPair * n * (n - 1);
+        uint64_t single = 0, dual = 0, warm = 0, learned = 0;
+        memset(reverse, 0, sizeof(reverse));
+        memset(heard, 0, sizeof(heard));
+
+        for(uint64_t f=0; f<frames; f++)
+        {
+            uint32_t src = linkRandom() % n;
+            uint32_t dst = (src + 1 + (linkRandom() % (n - 1))) % n;
+            uint32_t forward = (dst + n - src) % n;
+            uint8_t back = reverse[src][dst];
+            uint32_t links = back ? (n - forward) : forward;
+
+            if(f == (frames / 2))
+            {
+                for(uint32_t a=0; a<n; a++)
+                    for(uint32_t b=0; b<n; b++)
+                        learned += heard[a][b];
+            }
+            learn(n, dst, src, links, back);
+            single += forward;
+            dual += links;
+            if(f >= (frames / 2))
+                warm += links;
+        }
+        printf("%-8u%12llu%12.2f%12.2f%12.2f%11.1f%%%12.2f\n", n, (unsigned long long)frames,
+               (double)single / frames, (double)dual / frames, (double)warm / (frames - (frames / 2)),
+               (100.0 * learned) / ((uint64_t)n * (n - 1)), n / 4.0);
+    }
+    return 0;
+}
@@ -0,0 +1,426 @@
+/*!
+  * \brief      End-to-end throughput and latency of a virtual ring running the firmware
+  * \details    Loads ring/node1.so to ring/noden.so like ring_emu, but drives them from one thread in virtual time,
+  *             so a run gives the same numbers every time. Every node hands a frame to sendFrame as soon as its
+  *             transmitter is free, the ring runs saturated for the given time, for every mix and payload size.
+  *             "-l load" makes a node wait after each of its frames, so its own frames keep its transmitter busy
+  *             that percentage of the time at most. Frames still on their way when the time is up may arrive
+  *             afterwards, nothing new is handed over then. The mixes are:
+  *               unicast     to a random other node
+  *               broadcast   to every node
+  *               relay       to the node behind it, across the whole ring
+  *             SENT counts the frames handed to sendFrame, FPS and GOODPUT the frames that arrived, a broadcast
+  *             once, LOSS the share of SENT that never arrived, HOP the latency from sendFrame to delivery divided
+  *             by the hops it took, BITRATE the clock edges on the wire per second.
+  *             Where the rest goes: the firmware has no relay queue here, so a frame to be relayed takes the
+  *             transmitter at once and the frame still on the wire is cut off (CUT, stats.txCut of all nodes) -
+  *             what went out of it fails the crc downstream (CRC), or is never seen at all when it was cut within
+  *             its preamble. Saturated, the next frame of a node starts just as the relays reach it, so nearly
+  *             every relay cuts one off: LOSS is about half for unicast on 4 nodes and grows with the hops a
+  *             frame needs, broadcast and relay cross the whole ring. DROPPED sums the drop counters of the
+  *             features the build turns on, e.g. TTL or jumbo. Saturated numbers measure that design under
+  *             overload, not the wire - "make suite" runs below it with "-l", and a ring that must not lose
+  *             frames needs USE_QUEUE, which this bench cannot drive from one thread.
+  *             "-o file" appends one line per point to a csv file that e2e_compare checks against a baseline.
+  *             Usage: ./e2e_bench [-n nodes] [-s seconds] [-l load] [-m mix,...] [-p payload,...] [-o file] */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dlfcn.h>
+#include "raspnet.h"
+#include "../src/layer3.h"
+#include "../src/stats.h"
+
+#if USE_TOKEN || USE_TDMA || USE_QUEUE || USE_ARQ
+#error "sendFrame waits for the token, the slot, the arbiter or the ARQ window of the node, which needs the threads of ring_emu"
+#endif
+
+#define MAX_NODES       32
+#define MAX_POINTS      64
+#define LINE_SIZE       64
+
+#define MIX_UNICAST     0
+#define MIX_BROADCAST   1
+#define MIX_RELAY       2
+
+#define PINS_UPSTREAM   (HAL_PIN_CLOCK | HAL_PIN_DATA)
+#define PINS_DOWNSTREAM (HAL_PIN_CLOCK2 | HAL_PIN_DATA2 | HAL_PIN_READY)
+
+const char* _mixes[3] = { "unicast", "broadcast", "relay" };
+
+typedef struct
+{
+    void* handle;
+    void (*compareB)();
+    void (*compareA)();
+    void (*drive)(const uint8_t pins);
+    void (*send)(frame_t* frame);
+    volatile uint8_t* out;
+    volatile uint32_t* pFlag;
+    volatile stats_t* stats;
+    uint8_t seq;
+    uint64_t sentTick[256];
+    uint8_t busy;
+    uint64_t nextOffer;
+
+    char line[LINE_SIZE];
+    uint32_t lineLength;
+} node_t;
+
+/// Results of one point
+typedef struct
+{
+    uint64_t sent;
+    double delivered;
+    uint64_t crcFailed;
+    uint64_t cut;
+    uint64_t dropped;
+    uint64_t edges;
+    double hopTicks;
+    uint64_t hopCount;
+    double hopMax;
+} point_t;
+
+static node_t _nodes[MAX_NODES];
+static uint32_t _ring;
+static uint32_t _payload;
+static uint8_t _mix;
+static uint32_t _load = 100;
+static uint8_t _current;
+static uint64_t _tick;
+static uint64_t _random = 1;
+static point_t _point;
+
+uint32_t nextRandom()
+{
+    _random = (_random * 6364136223846793005ULL) + 1442695040888963407ULL;
+    return (uint32_t)(_random >> 33);
+}
+
+/// Serial port of the nodes - only "CRC NO" is of interest
+void consoleTx(const uint8_t node, const unsigned char data)
+{
+    node_t* n = &_nodes[node - 1];
+    if((data != '\n') && (n->lineLength < (LINE_SIZE - 1)))
+    {
+        n->line[n->lineLength++] = data;
+        return;
+    }
+    n->line[n->lineLength] = 0;
+    n->lineLength = 0;
+    if(strstr(n->line, "CRC NO"))
+        _point.crcFailed++;
+}
+
+int16_t consoleRx(const uint8_t node)
+{
+    return -1;
+}
+
+/// Upper layer of the node whose receiver runs
+void onFrame(const frame_t* frame)
+{
+    uint8_t src = frame->payload[HDR_SRC];
+    if((src < 1) || (src > _ring) || (FRAME_LENGTH(frame) != (HDR_SIZE + _payload)))
+        return;
+    uint32_t hops = ((_current - src + _ring) % _ring);
+    double ticks = (double)(_tick - _nodes[src - 1].sentTick[frame->payload[HDR_SIZE]]) / hops;
+    _point.delivered += (frame->payload[HDR_DST] == BROADCAST_ID) ? (1.0 / (_ring - 1)) : 1.0;
+    _point.hopTicks += ticks;
+    _point.hopCount++;
+    if(ticks > _point.hopMax)
+        _point.hopMax = ticks;
+}
+
+int load(const uint32_t id)
+{
+    char path[64];
+    node_t* n = &_nodes[id - 1];
+    memset(n, 0, sizeof(node_t));
+    snprintf(path, sizeof(path), "./ring/node%u.so", id);
+    n->handle = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+    if(!n->handle)
+    {
+        fprintf(stderr, "%s\n", dlerror());
+        return 0;
+    }
+
+    n->compareB = (void (*)())dlsym(n->handle, "halCompareB");
+    n->compareA = (void (*)())dlsym(n->handle, "halCompareA");
+    n->drive = (void (*)(const uint8_t))dlsym(n->handle, "halDrive");
+    n->send = (void (*)(frame_t*))dlsym(n->handle, "sendFrame");
+    n->out = (volatile uint8_t*)dlsym(n->handle, "halOut");
+    n->pFlag = (volatile uint32_t*)dlsym(n->handle, "pFlag");
+    n->stats = (volatile stats_t*)dlsym(n->handle, "stats");
+    void (*ioSetup)() = (void (*)())dlsym(n->handle, "io_setup");
+    void (*interruptSetup)() = (void (*)())dlsym(n->handle, "interrupt_setup");
+    void (*pinChangeSetup)() = (void (*)())dlsym(n->handle, "pin_change_setup");
+    void (*linkInit)() = (void (*)())dlsym(n->handle, "linkInit");
+    volatile uint8_t* realTime = (volatile uint8_t*)dlsym(n->handle, "halRealTime");
+    volatile uint8_t* node = (volatile uint8_t*)dlsym(n->handle, "halNode");
+    void (**tx)(const uint8_t, const unsigned char) = dlsym(n->handle, "halUartTx");
+    int16_t (**rx)(const uint8_t) = dlsym(n->handle, "halUartRx");
+    void (**deliver)(const frame_t*) = dlsym(n->handle, "linkOnFrame");
+    if(!n->compareB || !n->compareA || !n->drive || !n->send || !n->out || !n->pFlag || !n->stats || !ioSetup ||
+       !interruptSetup || !pinChangeSetup || !linkInit || !realTime || !node || !tx || !rx || !deliver)
+    {
+        fprintf(stderr, "%s is not a POSIX build of the firmware\n", path);
+        return 0;
+    }
+
+    // No timer thread - the bench is the clock
+    *realTime = 0;
+    *node = id;
+    *tx = consoleTx;
+    *rx = consoleRx;
+    ioSetup();
+    interruptSetup();
+    pinChangeSetup();
+    linkInit();
+    *deliver = onFrame;
+    return 1;
+}
+
+/// Frames the features of the build dropped on purpose
+uint64_t dropped(volatile stats_t* s)
+{
+    uint64_t count = 0;
+#if USE_JUMBO
+    count += s->jumboDropped;
+#endif
+#if USE_AGG
+    count += s->aggDropped;
+#endif
+#if USE_TTL
+    count += s->ttlExpired;
+#endif
+#if USE_BRIDGE
+    count += s->bridgeDropped;
+#endif
+#if USE_DUAL
+    count += s->dualDropped;
+#endif
+    return count;
+}
+
+void unload()
+{
+    for(uint32_t i=0; i<_ring; i++)
+    {
+        _point.cut += _nodes[i].stats->txCut;
+        _point.dropped += dropped(_nodes[i].stats);
+        dlclose(_nodes[i].handle);
+    }
+}
+
+/// Passes the pins of every node on to its neighbours, running the receivers one after the other
+void wire()
+{
+    uint8_t pins[MAX_NODES];
+    for(uint32_t i=0; i<_ring; i++)
+        pins[i] = *_nodes[i].out;
+    for(uint32_t i=0; i<_ring; i++)
+    {
+        uint8_t upstream = pins[((i + _ring - 1) % _ring)];
+        uint8_t downstream = pins[((i + 1) % _ring)];
+        _current = (i + 1);
+        _nodes[i].drive((upstream & PINS_UPSTREAM) | (downstream & PINS_DOWNSTREAM));
+    }
+}
+
+/// Next frame of a node whose transmitter is free
+void offer(const uint32_t id)
+{
+    node_t* n = &_nodes[id - 1];
+    frame_t frame;
+    memset(&frame, 0, sizeof(frame));
+    SET_LENGTH(&frame, (HDR_SIZE + _payload));
+    if(_mix == MIX_BROADCAST)
+        frame.payload[HDR_DST] = BROADCAST_ID;
+    else if(_mix == MIX_RELAY)
+        frame.payload[HDR_DST] = (((id + _ring - 2) % _ring) + 1);
+    else
+        frame.payload[HDR_DST] = (((id - 1 + 1 + (nextRandom() % (_ring - 1))) % _ring) + 1);
+    frame.payload[HDR_SRC] = id;
+    for(uint32_t i=1; i<_payload; i++)
+        frame.payload[HDR_SIZE + i] = (uint8_t)(id + i);
+    frame.payload[HDR_SIZE] = n->seq;
+    n->sentTick[n->seq++] = _tick;
+    n->send(&frame);
+    n->busy = 1;
+    _point.sent++;
+}
+
+/// Hands the next frame of a node over once its transmitter is free and the wait of the load is over
+void poll(const uint32_t id)
+{
+    node_t* n = &_nodes[id - 1];
+    if(*n->pFlag != PRIORITY_IDLE)
+        return;
+    if(n->busy)
+    {
+        uint64_t took = (_tick - n->sentTick[(uint8_t)(n->seq - 1)]);
+        n->nextOffer = _tick + ((took * (100 - _load)) / _load);
+        n->busy = 0;
+    }
+    if(_tick >= n->nextOffer)
+        offer(id);
+}
+
+/// One timer period of every node
+void step()
+{
+    for(uint32_t i=0; i<_ring; i++)
+    {
+        _current = (i + 1);
+        _nodes[i].compareB();
+    }
+    wire();
+    for(uint32_t i=0; i<_ring; i++)
+    {
+        _current = (i + 1);
+        _nodes[i].compareA();
+    }
+    wire();
+}
+
+int run(const uint64_t ticks)
+{
+    memset(&_point, 0, sizeof(_point));
+    _random = 1;
+    for(uint32_t id=1; id<=_ring; id++)
+        if(!load(id))
+            return 0;
+
+    uint8_t clock = 0;
+    for(_tick=0; _tick<ticks; _tick++)
+    {
+        for(uint32_t id=1; id<=_ring; id++)
+            poll(id);
+        step();
+        if((*_nodes[0].out & HAL_PIN_CLOCK) != clock)
+        {
+            clock = (*_nodes[0].out & HAL_PIN_CLOCK);
+            _point.edges++;
+        }
+    }
+    // No frame is handed over after the time is up, those on their way may still arrive - for as long as the
+    // slowest hop so far took once around the ring
+    for(uint64_t end=(ticks + (uint64_t)((_ring + 1) * _point.hopMax)); _tick<end; _tick++)
+        step();
+    unload();
+    return 1;
+}
+
+/// Reads "v1,v2,..." into values, returns their number
+uint32_t parseList(const char* arg, uint32_t* values)
+{
+    uint32_t count = 0;
+    while(*arg && (count < MAX_POINTS))
+    {
+        char* end;
+        values[count++] = strtoul(arg, &end, 10);
+        if(end == arg)
+            return 0;
+        arg = (*end == ',') ? (end + 1) : end;
+    }
+    return count;
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t payloads[MAX_POINTS] = { 1, 8, 32, 64, 128, 249 };
+    uint32_t payloadCount = 6;
+    uint8_t mixes[3] = { MIX_UNICAST, MIX_BROADCAST, MIX_RELAY };
+    uint32_t mixCount = 3;
+    double seconds = 300.0;
+    const char* path = 0;
+    _ring = 4;
+
+    for(int i=1; i<argc; i++)
+    {
+        if(!strcmp(argv[i], "-n") && ((i + 1) < argc))
+            _ring = atoi(argv[++i]);
+        else if(!strcmp(argv[i], "-s") && ((i + 1) < argc))
+            seconds = atof(argv[++i]);
+        else if(!strcmp(argv[i], "-l") && ((i + 1) < argc))
+            _load = atoi(argv[++i]);
+        else if(!strcmp(argv[i], "-p") && ((i + 1) < argc))
+            payloadCount = parseList(argv[++i], payloads);
+        else if(!strcmp(argv[i], "-o") && ((i + 1) < argc))
+            path = argv[++i];
+        else if(!strcmp(argv[i], "-m") && ((i + 1) < argc))
+        {
+            char* list = argv[++i];
+            mixCount = 0;
+            for(uint8_t m=0; m<3; m++)
+                if(strstr(list, _mixes[m]))
+                    mixes[mixCount++] = m;
+        }
+        else
+        {
+            fprintf(stderr, "unknown argument %s\n", argv[i]);
+            return 1;
+        }
+    }
+    if((_ring < 2) || (_ring > MAX_NODES) || !payloadCount || !mixCount || (seconds <= 0.0) || (_load < 1) ||
+       (_load > 100))
+    {
+        fprintf(stderr, "ring size 2 to %u, load 1 to 100, payload sizes, mixes of unicast, broadcast and relay\n",
+                MAX_NODES);
+        return 1;
+    }
+
+    FILE* out = 0;
+    if(path)
+    {
+        out = fopen(path, "a");
+        if(!out)
+        {
+            fprintf(stderr, "cannot write %s\n", path);
+            return 1;
+        }
+        if(!ftell(out))
+            fprintf(out, "backend,nodes,bitrate,mix,payload,load,seconds,sent,delivered,crc,cut,dropped,loss,fps,"
+                         "goodput,hop_ms,hop_max_ms\n");
+    }
+
+    uint64_t ticks = (uint64_t)((seconds * 1e6) / HAL_TICK_US);
+    printf("ring of %u nodes, %.0f s each, load %u%%\n\n", _ring, seconds, _load);
+    printf("%-10s%8s%9s%9s%10s%7s%7s%8s%7s%9s%10s%10s%10s\n", "MIX", "PAYLOAD", "BITRATE", "SENT", "DELIVERED",
+           "CRC", "CUT", "DROPPED", "LOSS %", "FPS", "GOODPUT", "HOP ms", "HOP MAX");
+    for(uint32_t m=0; m<mixCount; m++)
+    {
+        for(uint32_t p=0; p<payloadCount; p++)
+        {
+            _mix = mixes[m];
+            _payload = payloads[p];
+            if((_payload < 1) || ((HDR_SIZE + _payload) > LEGACY_PAYLOAD))
+            {
+                fprintf(stderr, "payload %u skipped, 1 to %u\n", _payload, LEGACY_PAYLOAD - HDR_SIZE);
+                continue;
+            }
+            if(!run(ticks))
+                return 1;
+
+            double bitrate = _point.edges / seconds;
+            double fps = _point.delivered / seconds;
+            double goodput = (fps * _payload * 8);
+            double hop = _point.hopCount ? ((_point.hopTicks / _point.hopCount) * HAL_TICK_US / 1000.0) : 0.0;
+            double hopMax = (_point.hopMax * HAL_TICK_US / 1000.0);
+            double loss = (_point.delivered < _point.sent) ? (100.0 * (1.0 - (_point.delivered / _point.sent))) : 0.0;
+            printf("%-10s%8u%9.1f%9llu%10.1f%7llu%7llu%8llu%7.1f%9.3f%10.1f%10.1f%10.1f\n", _mixes[_mix], _payload,
+                   bitrate, (unsigned long long)_point.sent, _point.delivered, (unsigned long long)_point.crcFailed,
+                   (unsigned long long)_point.cut, (unsigned long long)_point.dropped, loss, fps, goodput, hop,
+                   hopMax);
+            if(out)
+                fprintf(out, "emu,%u,%.1f,%s,%u,%u,%.0f,%llu,%.1f,%llu,%llu,%llu,%.2f,%.4f,%.2f,%.2f,%.2f\n",
+                        _ring, bitrate, _mixes[_mix], _payload, _load, seconds, (unsigned long long)_point.sent, _point.delivered,
+                        (unsigned long long)_point.crcFailed, (unsigned long long)_point.cut,
+                        (unsigned long long)_point.dropped, loss, fps, goodput, hop, hopMax);
+        }
+    }
+    if(out)
+        fclose(out);
+    return 0;
+}
@@ -0,0 +1,178 @@
+/*!
+  * \brief      Checks results of e2e_bench against a stored baseline
+  * \details    Rows of both csv files are matched by backend, nodes, bitrate, mix, payload and load. A row is worse when
+  *             FPS or GOODPUT fell, or HOP or LOSS rose, by more than the tolerance - those are listed and make
+  *             the exit status 1. Better rows are listed too, a new baseline is the results file copied over it.
+  *             Rows without a match in the baseline are listed as NEW and not checked at all.
+  *             Usage: ./e2e_compare baseline.csv results.csv [tolerance in percent] */
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define MAX_ROWS        4096
+#define MAX_COLUMNS     16
+#define LINE_SIZE       512
+
+#define KEYS            6
+#define METRICS         4
+
+/// Columns of the key and the metrics, higher is better for all but hop_ms and loss
+const char* _keys[KEYS] = { "backend", "nodes", "bitrate", "mix", "payload", "load" };
+const char* _metrics[METRICS] = { "fps", "goodput", "hop_ms", "loss" };
+const int _higher[METRICS] = { 1, 1, 0, 0 };
+
+typedef struct
+{
+    char key[128];
+    double values[METRICS];
+    int present[METRICS];
+    int matched;
+} row_t;
+
+typedef struct
+{
+    row_t* rows;
+    uint32_t count;
+} table_t;
+
+/// Splits a csv line in place, returns the number of fields
+int split(char* line, char** fields)
+{
+    int count = 0;
+    line[strcspn(line, "\r\n")] = 0;
+    fields[count++] = line;
+    for(char* p=line; *p && (count < MAX_COLUMNS); p++)
+    {
+        if(*p != ',')
+            continue;
+        *p = 0;
+        fields[count++] = (p + 1);
+    }
+    return count;
+}
+
+int column(char** header, const int count, const char* name)
+{
+    for(int i=0; i<count; i++)
+        if(!strcmp(header[i], name))
+            return i;
+    return -1;
+}
+
+int readTable(const char* path, table_t* table)
+{
+    FILE* in = fopen(path, "r");
+    if(!in)
+    {
+        fprintf(stderr, "cannot read %s\n", path);
+        return 0;
+    }
+    char header[LINE_SIZE], line[LINE_SIZE];
+    char* names[MAX_COLUMNS];
+    char* fields[MAX_COLUMNS];
+    if(!fgets(header, sizeof(header), in))
+    {
+        fprintf(stderr, "%s is empty\n", path);
+        fclose(in);
+        return 0;
+    }
+    int columns = split(header, names);
+    int keys[KEYS], metrics[METRICS];
+    for(int k=0; k<KEYS; k++)
+    {
+        keys[k] = column(names, columns, _keys[k]);
+        if(keys[k] < 0)
+        {
+            fprintf(stderr, "%s has no column %s\n", path, _keys[k]);
+            fclose(in);
+            return 0;
+        }
+    }
+    for(int m=0; m<METRICS; m++)
+        metrics[m] = column(names, columns, _metrics[m]);
+
+    table->rows = calloc(MAX_ROWS, sizeof(row_t));
+    table->count = 0;
+    while(fgets(line, sizeof(line), in) && (table->count < MAX_ROWS))
+    {
+        int count = split(line, fields);
+        if(count != columns)
+            continue;
+        row_t* r = &table->rows[table->count++];
+        snprintf(r->key, sizeof(r->key), "%s %s nodes %s bit/s %s %s bytes %s%% load", fields[keys[0]],
+                 fields[keys[1]], fields[keys[2]], fields[keys[3]], fields[keys[4]], fields[keys[5]]);
+        for(int m=0; m<METRICS; m++)
+        {
+            r->present[m] = ((metrics[m] >= 0) && *fields[metrics[m]]);
+            r->values[m] = r->present[m] ? atof(fields[metrics[m]]) : 0.0;
+        }
+    }
+    fclose(in);
+    return 1;
+}
+
+row_t* findRow(table_t* table, const char* key)
+{
+    for(uint32_t i=0; i<table->count; i++)
+        if(!strcmp(table->rows[i].key, key))
+            return &table->rows[i];
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    if(argc < 3)
+    {
+        fprintf(stderr, "usage: %s baseline.csv results.csv [tolerance in percent]\n", argv[0]);
+        return 1;
+    }
+    double tolerance = ((argc > 3) ? atof(argv[3]) : 5.0) / 100.0;
+    table_t baseline, results;
+    if(!readTable(argv[1], &baseline) || !readTable(argv[2], &results))
+        return 1;
+
+    uint32_t worse = 0, better = 0, missing = 0, added = 0;
+    for(uint32_t i=0; i<results.count; i++)
+    {
+        row_t* r = &results.rows[i];
+        row_t* b = findRow(&baseline, r->key);
+        if(!b)
+        {
+            printf("NEW     %s - no baseline, not checked\n", r->key);
+            added++;
+            continue;
+        }
+        b->matched = 1;
+        for(int m=0; m<METRICS; m++)
+        {
+            if(!r->present[m] || !b->present[m])
+                continue;
+            double change = (b->values[m] != 0.0) ? ((r->values[m] - b->values[m]) / fabs(b->values[m]))
+                                                  : ((r->values[m] != 0.0) ? 1.0 : 0.0);
+            if(fabs(change) <= tolerance)
+                continue;
+            int good = ((change > 0) == _higher[m]);
+            printf("%-8s%s: %s %g -> %g (%+.1f%%)\n", good ? "BETTER" : "WORSE", r->key, _metrics[m],
+                   b->values[m], r->values[m], change * 100.0);
+            if(good)
+                better++;
+            else
+                worse++;
+        }
+    }
+    for(uint32_t i=0; i<baseline.count; i++)
+    {
+        if(baseline.rows[i].matched)
+            continue;
+        printf("MISSING %s\n", baseline.rows[i].key);
+        missing++;
+    }
+
+    printf("\n%u rows against %u of the baseline, tolerance %.1f%%: %u worse, %u better, %u new and unchecked, %u missing\n",
+           results.count, baseline.count, tolerance * 100.0, worse, better, added, missing);
+    free(baseline.rows);
+    free(results.rows);
+    return worse ? 1 : 0;
+}
@@ -0,0 +1,66 @@
+#pragma once
+#include <stdio.h>
+#include <stdlib.h>
+#include "event.h"
+
+/// One queue per thread, so simulations may run side by side
+__thread event_t _eventHeap[EVENT_CAPACITY];
+__thread uint32_t _eventCount = 0;
+
+void eventClear()
+{
+    _eventCount = 0;
+}
+
+void eventPush(const event_t event)
+{
+    if(_eventCount >= EVENT_CAPACITY)
+    {
+        fprintf(stderr, "event queue full\n");
+        exit(1);
+    }
+
+    uint32_t i = _eventCount++;
+    while(i > 0)
+    {
+        uint32_t parent = ((i-1) / 2);
+        if(_eventHeap[parent].time <= event.time)
+            break;
+        _eventHeap[i] = _eventHeap[parent];
+        i = parent;
+    }
+    _eventHeap[i] = event;
+}
+
+event_t eventPop()
+{
+    event_t top = _eventHeap[0];
+    event_t last = _eventHeap[--_eventCount];
+
+    uint32_t i = 0;
+    for(;;)
+    {
+        uint32_t child = (2*i) + 1;
+        if(child >= _eventCount)
+            break;
+        if(((child+1) < _eventCount) && (_eventHeap[child+1].time < _eventHeap[child].time))
+            child++;
+        if(last.time <= _eventHeap[child].time)
+            break;
+        _eventHeap[i] = _eventHeap[child];
+        i = child;
+    }
+    if(_eventCount > 0)
+        _eventHeap[i] = last;
+    return top;
+}
+
+uint32_t eventCount()
+{
+    return _eventCount;
+}
+
+uint64_t eventNext()
+{
+    return (_eventCount > 0) ? _eventHeap[0].time : UINT64_MAX;
+}
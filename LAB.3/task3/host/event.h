@@ -0,0 +1,41 @@
+#pragma once
+#include <stdint.h>
+
+/// Simulation event - the meaning of the fields after "type" is up to the simulation
+typedef struct
+{
+    uint64_t time;      ///< Bit time at which the event happens
+    uint8_t type;
+    uint8_t node;
+    uint8_t seq;
+    uint8_t ok;         ///< 1 if the frame arrived without bit errors
+    uint8_t arg;
+} event_t;
+
+/// Pending events as a binary min-heap on "time"
+#define EVENT_CAPACITY  4096
+
+/*! \brief      Removes every pending event
+  * \return     void */
+void eventClear();
+
+
+/*! \brief      Schedules an event, events of the same time come out in any order
+  * \param      event   - Event to be scheduled
+  * \return     void */
+void eventPush(const event_t event);
+
+
+/*! \brief      Takes the earliest event out of the queue
+  * \return     event_t - The earliest event */
+event_t eventPop();
+
+
+/*! \brief      Returns the number of pending events
+  * \return     unsigned 32-bits data */
+uint32_t eventCount();
+
+
+/*! \brief      Returns the time of the earliest event without removing it
+  * \return     unsigned 64-bits data - Bit time, or UINT64_MAX if the queue is empty */
+uint64_t eventNext();
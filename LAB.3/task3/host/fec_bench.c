@@ -0,0 +1,108 @@
+/*!
+  * \brief      Host benchmark of the Hamming(12,8) mode against the plain frame
+  * \details    Sends random frames over a simulated link with injected bit errors.
+  *             A frame counts as delivered when it arrives bit-exact, which is what the crc check decides on the node.
+  *             Usage: ./fec_bench [frames per point] */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "link.c"
+#undef USE_FEC
+#define USE_FEC 1
+#include "../src/fec.c"
+
+/// crc, dlc and payload bytes of a frame
+#define HEADER_BYTES    5
+#define PREAMBLE_BITS   8
+
+/// Sends the frame as plain bytes, returns 1 if it arrived intact
+uint8_t sendPlain(const uint8_t* frame, const uint32_t size, const double ber)
+{
+    uint8_t wire[HEADER_BYTES+256];
+    memcpy(wire, frame, size);
+
+    uint8_t preamble[1] = { 0x7e };
+    if(linkTransmit(preamble, PREAMBLE_BITS, ber))
+        return 0x00;
+    linkTransmit(wire, size*8, ber);
+    return (memcmp(wire, frame, size) == 0) ? 0x01 : 0x00;
+}
+
+/// Sends the frame as Hamming codewords, returns 1 if it was decoded intact
+uint8_t sendCoded(const uint8_t* frame, const uint32_t size, const double ber)
+{
+    uint8_t preamble[1] = { 0x7e };
+    if(linkTransmit(preamble, PREAMBLE_BITS, ber))
+        return 0x00;
+
+    for(uint32_t i=0; i<size; i++)
+    {
+        uint16_t code = hammingEncode(frame[i]);
+        for(uint8_t b=0; b<12; b++)
+        {
+            if(linkError(ber))
+                code ^= (1 << b);
+        }
+
+        uint8_t data;
+        hammingDecode(code, &data);
+        if(data != frame[i])
+            return 0x00;
+    }
+    return 0x01;
+}
+
+int main(int argc, char** argv)
+{
+    const uint32_t frames = (argc > 1) ? (uint32_t)atoi(argv[1]) : 2000;
+    const uint32_t dlcs[3] = { 6, 64, 249 };
+    const double bers[6] = { 0.0, 1e-5, 1e-4, 1e-3, 3e-3, 1e-2 };
+
+    linkSeed(1);
+
+    printf("%-8s %-4s %-6s %10s %10s %10s\n", "BER", "DLC", "MODE", "WIRE BITS", "DELIVERED", "GOODPUT");
+    for(int d=0; d<3; d++)
+    {
+        const uint32_t size = HEADER_BYTES + dlcs[d];
+        const uint32_t plainBits = PREAMBLE_BITS + (size*8);
+        const uint32_t codedBits = PREAMBLE_BITS + (size*12);
+
+        for(int b=0; b<6; b++)
+        {
+            uint32_t plainOk = 0;
+            uint32_t codedOk = 0;
+            uint8_t frame[HEADER_BYTES+256];
+
+            for(uint32_t f=0; f<frames; f++)
+            {
+                frame[4] = dlcs[d];
+                for(uint32_t i=0; i<size; i++)
+                    if(i != 4) frame[i] = linkRandom();
+
+                plainOk += sendPlain(frame, size, bers[b]);
+                codedOk += sendCoded(frame, size, bers[b]);
+            }
+
+            // Goodput - delivered payload bits per bit on the wire
+            printf("%-8g %-4u %-6s %10u %9.1f%% %10.3f\n", bers[b], dlcs[d], "plain", plainBits,
+                (100.0*plainOk)/frames, ((double)plainOk*dlcs[d]*8)/((double)frames*plainBits));
+            printf("%-8g %-4u %-6s %10u %9.1f%% %10.3f\n", bers[b], dlcs[d], "fec", codedBits,
+                (100.0*codedOk)/frames, ((double)codedOk*dlcs[d]*8)/((double)frames*codedBits));
+        }
+    }
+
+    // Codec speed on this host
+    const uint32_t rounds = 10000000;
+    uint64_t start = linkNow();
+    uint32_t sink = 0;
+    for(uint32_t i=0; i<rounds; i++)
+    {
+        uint8_t data;
+        hammingDecode(hammingEncode((uint8_t)i), &data);
+        sink += data;
+    }
+    uint64_t elapsed = linkNow() - start;
+    printf("\nencode+decode %.1f ns/byte (checksum %u)\n", (double)elapsed/rounds, sink);
+
+    return 0;
+}
@@ -0,0 +1,159 @@
+/*!
+  * \brief      Host simulation of the back-pressure of USE_FLOW on a saturated ring
+  * \details    Every node always has frames of its own to random destinations and a relay queue of
+  *             QUEUE_RELAY_BYTES in front of its transmitter, the room of one full frame shared by shorter ones.
+  *             Without flow control the arbiter takes turns between relayed and own frames, and a relayed
+  *             frame that finds no room is lost.
+  *             With flow control a node sends its own frames only while its relay queue and the one
+  *             of its downstream node are below the high-water mark, as flowMayInject decides.
+  *             Usage: ./flow_sim [ring size] [seconds] */
+#include <stdio.h>
+#include <stdlib.h>
+#include "link.c"
+#include "event.c"
+
+#define PREAMBLE_BITS   8
+#define HEADER_BITS     40
+#define POOL_BYTES      (4 + 1 + 251)
+#define ENTRIES         8
+#define FRAME_BYTES(f)  (4 + 1 + (f).bytes)
+#define HIGH_WATER      1
+#define MAX_NODES       64
+
+#define EVENT_DONE      1
+
+typedef struct
+{
+    uint8_t dst;
+    uint16_t bytes;
+    uint64_t born;
+} sim_frame_t;
+
+typedef struct
+{
+    sim_frame_t relay[ENTRIES];
+    uint32_t head, count, used;
+    sim_frame_t own;
+    sim_frame_t wire;
+    uint8_t busy;
+    uint8_t turn;
+} node_t;
+
+static node_t _nodes[MAX_NODES];
+static uint32_t _ring;
+
+typedef struct
+{
+    uint64_t delivered, dropped, latency;
+} result_t;
+
+sim_frame_t newFrame(const uint32_t src, const uint64_t now)
+{
+    sim_frame_t f;
+    f.dst = (src + 1 + (linkRandom() % (_ring - 1))) % _ring;
+    f.bytes = 8 + (linkRandom() % 120);
+    f.born = now;
+    return f;
+}
+
+/// Starts the next frame of an idle node, "flow" selects the arbiter
+void start(const uint32_t n, const uint64_t now, const uint8_t flow)
+{
+    node_t* node = &_nodes[n];
+    if(node->busy)
+        return;
+
+    uint8_t own;
+    if(flow)
+        own = (node->count < HIGH_WATER) && (_nodes[((n + 1) % _ring)].count < HIGH_WATER);
+    else
+        own = (node->count == 0) || (node->turn ^= 1);
+
+    if(own)
+    {
+        node->wire = node->own;
+        node->own = newFrame(n, now);
+    }
+    else if(node->count)
+    {
+        node->wire = node->relay[node->head];
+        node->used -= FRAME_BYTES(node->wire);
+        node->head = (node->head + 1) % ENTRIES;
+        node->count--;
+    }
+    else
+        return;
+
+    node->busy = 1;
+    event_t e = { .time = now + PREAMBLE_BITS + HEADER_BITS + (node->wire.bytes * 8), .type = EVENT_DONE, .node = (uint8_t)n };
+    eventPush(e);
+}
+
+result_t run(const uint64_t duration, const uint8_t flow)
+{
+    result_t r = { 0, 0, 0 };
+    eventClear();
+    for(uint32_t n=0; n<_ring; n++)
+    {
+        _nodes[n] = (node_t){ .head = 0 };
+        _nodes[n].own = newFrame(n, 0);
+    }
+    for(uint32_t n=0; n<_ring; n++)
+        start(n, 0, flow);
+
+    while(eventCount() && (eventNext() < duration))
+    {
+        event_t e = eventPop();
+        node_t* node = &_nodes[e.node];
+        uint32_t next = (e.node + 1) % _ring;
+        node_t* down = &_nodes[next];
+        sim_frame_t f = node->wire;
+
+        node->busy = 0;
+        if(f.dst == next)
+        {
+            r.delivered++;
+            r.latency += e.time - f.born;
+        }
+        else if((down->count >= ENTRIES) || ((down->used + FRAME_BYTES(f)) > POOL_BYTES))
+            r.dropped++;
+        else
+        {
+            down->relay[((down->head + down->count) % ENTRIES)] = f;
+            down->count++;
+            down->used += FRAME_BYTES(f);
+        }
+
+        // The ready lines changed, so the upstream node may start as well
+        start(next, e.time, flow);
+        start(e.node, e.time, flow);
+        start(((e.node + _ring - 1) % _ring), e.time, flow);
+    }
+    return r;
+}
+
+int main(int argc, char** argv)
+{
+    _ring = (argc > 1) ? atoi(argv[1]) : 8;
+    const double seconds = (argc > 2) ? atof(argv[2]) : 3600.0;
+    const uint64_t duration = (uint64_t)(seconds * LINK_BITRATE);
+
+    if((_ring < 2) || (_ring > MAX_NODES))
+    {
+        fprintf(stderr, "ring size 2 to %u\n", MAX_NODES);
+        return 1;
+    }
+
+    linkSeed(1);
+    printf("saturated ring of %u nodes, %g s, relay queue of %u bytes\n\n", _ring, seconds, POOL_BYTES);
+    printf("%-14s%12s%12s%12s%14s\n", "FLOW CONTROL", "DELIVERED", "DROPPED", "DROP RATE", "AVG LATENCY");
+    for(uint8_t flow=0; flow<2; flow++)
+    {
+        result_t r = run(duration, flow);
+        printf("%-14s%12llu%12llu%11.2f%%%12.1f s\n", flow ? "ready line" : "off",
+               (unsigned long long)r.delivered, (unsigned long long)r.dropped,
+               (100.0 * r.dropped) / (r.delivered + r.dropped),
+               r.delivered ? ((double)r.latency / r.delivered / LINK_BITRATE) : 0.0);
+    }
+    return 0;
+}
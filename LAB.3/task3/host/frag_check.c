@@ -0,0 +1,205 @@
+/*!
+  * \brief      Checks fragSend and the reassembly of fragment.c against each other
+  * \details    Built from the firmware with the POSIX backend and USE_FRAG. A second thread plays the transmitter:
+  *             it takes every frame sendFrame hands over and frees the transmitter again, so fragSend runs as it
+  *             does in the main loop. The captured fragments go back into deliverFrame in order, out of order,
+  *             with one of them lost and with the last one lost, then the longest message fragSend takes.
+  *             Usage: ./frag_check */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "../src/interrupt.c"
+
+#if !USE_FRAG
+#error "frag_check needs -DUSE_FRAG=1"
+#endif
+
+#define MAX_FRAMES      256
+
+static uint32_t _failed;
+
+/// Frames of the transmitter thread
+static frame_t _frames[MAX_FRAMES];
+static volatile uint32_t _count;
+
+/// Last message of fragOnMessage and the frames that went to linkOnFrame instead
+static uint8_t _buffer[FRAG_MAX_LENGTH];
+static uint8_t _sent[FRAG_MAX_LENGTH + 1];
+static uint32_t _messages;
+static uint16_t _length;
+static uint8_t _src;
+static uint32_t _plain;
+
+void expect(const int ok, const char* what)
+{
+    printf("%-6s%s\n", ok ? "OK" : "FAIL", what);
+    if(!ok)
+        _failed++;
+}
+
+void consoleSink(const uint8_t node, const unsigned char data)
+{
+}
+
+void onMessage(const uint8_t src, const uint8_t* data, const uint16_t length)
+{
+    _messages++;
+    _src = src;
+    _length = length;
+}
+
+void onFrame(const frame_t* frame)
+{
+    _plain++;
+}
+
+/// Takes every frame off the transmitter as soon as sendFrame is done with it
+void* transmitter(void* arg)
+{
+    for(;;)
+    {
+        if((pFlag == PRIORITY_SEND) && (tFlag == FLAG_SENDING_PREAMBLE))
+        {
+            if(_count < MAX_FRAMES)
+                _frames[_count] = *tFrame;
+            _count++;
+            clearFrame(tFrame);
+            tFlag = FLAG_IDLE;
+            pFlag = PRIORITY_IDLE;
+        }
+    }
+    return 0;
+}
+
+/// Fragments of one message with a pattern of its own
+uint32_t capture(const uint16_t length, const uint8_t seed)
+{
+    for(uint32_t i=0; i<length; i++)
+        _sent[i] = (uint8_t)(seed + (i * 7));
+    _count = 0;
+    if(!fragSend(OTHER_ID, _sent, length))
+        return 0;
+    while(pFlag != PRIORITY_IDLE);
+    return _count;
+}
+
+/// Order of the captured fragments as they were sent
+void inOrder(uint32_t* order, const uint32_t count)
+{
+    for(uint32_t i=0; i<count; i++)
+        order[i] = i;
+}
+
+/// Hands the captured fragments in the given order to the receiver, an index of MAX_FRAMES is a lost one
+void deliver(const uint32_t* order, const uint32_t count)
+{
+    for(uint32_t i=0; i<count; i++)
+        if(order[i] < MAX_FRAMES)
+            deliverFrame(&_frames[order[i]]);
+}
+
+uint8_t arrived(const uint16_t length)
+{
+    return (_messages == 1) && (_src == MY_ID) && (_length == length) && !memcmp(_buffer, _sent, length);
+}
+
+int main()
+{
+    pthread_t thread;
+    uint32_t order[MAX_FRAMES] = { 0 };
+
+    halRealTime = 0;
+    halUartTx = consoleSink;
+    linkInit();
+    linkOnFrame = onFrame;
+    fragOnMessage = onMessage;
+    fragProvide(_buffer, sizeof(_buffer));
+    pthread_create(&thread, 0, transmitter, 0);
+
+    // A message that fits into one frame still carries a fragment header and goes to fragOnMessage
+    uint32_t count = capture(4, 1);
+    inOrder(order, count);
+    _messages = 0;
+    deliver(order, count);
+    expect((count == 1) && arrived(4) && !_plain, "4 bytes in one fragment reach fragOnMessage, not linkOnFrame");
+
+    // Plain frames keep an all-zero fragment header
+    clearFrame(myFrame);
+    SET_LENGTH(myFrame, (HDR_SIZE + 4));
+    myFrame->payload[HDR_DST] = MY_ID;
+    myFrame->payload[HDR_SRC] = OTHER_ID;
+    _messages = 0;
+    deliverFrame(myFrame);
+    expect((_plain == 1) && !_messages, "a plain frame reaches linkOnFrame");
+
+    // In order
+    uint16_t length = (3 * FRAG_CHUNK) + 17;
+    count = capture(length, 2);
+    inOrder(order, count);
+    _messages = 0;
+    deliver(order, count);
+    expect((count == 4) && arrived(length), "4 fragments in order arrive as one message");
+
+    // Out of order - the ring keeps the order, so a swap is taken as a loss and the buffer is free again
+    count = capture(length, 3);
+    uint32_t dropped = stats.fragDropped;
+    order[0] = 0;
+    order[1] = 2;
+    order[2] = 1;
+    order[3] = 3;
+    _messages = 0;
+    deliver(order, count);
+    expect(!_messages && (stats.fragDropped > dropped), "fragments out of order are dropped, not delivered");
+    count = capture(length, 4);
+    inOrder(order, count);
+    _messages = 0;
+    deliver(order, count);
+    expect(arrived(length), "the next message after them arrives whole");
+
+    // A middle fragment lost
+    count = capture(length, 5);
+    dropped = stats.fragDropped;
+    inOrder(order, count);
+    order[1] = MAX_FRAMES;
+    _messages = 0;
+    deliver(order, count);
+    expect(!_messages && (stats.fragDropped > dropped), "a message with a lost middle fragment is dropped");
+
+    // The last fragment lost - only the reassembly timer frees the buffer
+    count = capture(length, 6);
+    inOrder(order, count);
+    order[count - 1] = MAX_FRAMES;
+    _messages = 0;
+    deliver(order, count);
+    uint32_t timeouts = stats.fragTimeouts;
+    fragPoll();
+    uint8_t held = (stats.fragTimeouts == timeouts);
+    ticks += (FRAG_TIMEOUT_BITS*BIT_TICKS) + 1;
+    fragPoll();
+    expect(!_messages && held && (stats.fragTimeouts == (timeouts + 1)),
+           "a message without its last fragment is released by the timer");
+    count = capture(length, 7);
+    inOrder(order, count);
+    _messages = 0;
+    deliver(order, count);
+    expect(arrived(length), "the buffer takes the next message after the timeout");
+
+    // The limits of the 15-bits offset
+    count = capture(FRAG_MAX_LENGTH, 8);
+    uint8_t flag = 1;
+    for(uint32_t i=0; i<count; i++)
+    {
+        order[i] = i;
+        if(((_frames[i].payload[FRAG_OFFSET] & FRAG_MORE) != 0) != (i < (count - 1)))
+            flag = 0;
+    }
+    _messages = 0;
+    deliver(order, count);
+    expect((count <= MAX_FRAMES) && flag && arrived(FRAG_MAX_LENGTH), "FRAG_MAX_LENGTH bytes arrive whole");
+    expect(!capture(FRAG_MAX_LENGTH + 1, 9) && !_count, "a longer message is refused before any fragment goes out");
+    expect(!capture(0, 10) && !_count, "so is an empty one");
+
+    printf("\n%s\n", _failed ? "FRAG CHECK FAILED" : "FRAG CHECK PASSED");
+    return _failed ? 1 : 0;
+}
@@ -0,0 +1,413 @@
+/*!
+  * \brief      Coverage-guided search for the longest single interrupt of the firmware
+  * \details    The firmware is built with the POSIX backend and -fsanitize-coverage=trace-pc, so every basic block
+  *             it enters calls __sanitizer_cov_trace_pc. That gives both the edges an input reached and the
+  *             blocks every interrupt ran, the instruction counter the search maximises - the harness itself is
+  *             left out with FUZZ_HARNESS.
+  *             An input is a bit stream, fed into the receiver one clock edge per bit with BIT_TICKS timer ticks
+  *             in between, on a fresh copy of the firmware in a child process. Inputs that reach new edges or
+  *             make a longer interrupt go into the corpus and are mutated further, frames for this node, for
+  *             another node and for all of them seed it.
+  *             The worst inputs are written to the output directory as bit streams (bits.h), cut after the bit
+  *             of their worst interrupt, so "-r" replays them as regression inputs. Block counts depend on the compiler, a new one needs new inputs.
+  *             Usage: ./isr_fuzz [-t seconds] [-s seed] [-o dir]
+  *                    ./isr_fuzz -r file.bits ... [-p tolerance in percent] */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include "bits.c"
+#include "../src/interrupt.c"
+
+#define FUZZ_HARNESS    __attribute__((no_sanitize_coverage))
+
+#define MAP_SIZE        65536
+#define CORPUS_SIZE     1024
+#define WORST_SIZE      8
+
+#define ISR_PCINT       0
+#define ISR_COMPB       1
+#define ISR_COMPA       2
+
+const char* _isrNames[3] = { "PCINT2_vect", "TIMER0_COMPB_vect", "TIMER0_COMPA_vect" };
+
+/// Shared with the child - edges it reached and its longest interrupt
+typedef struct
+{
+    uint8_t edges[MAP_SIZE];
+    uint64_t worst;
+    uint32_t worstBit;
+    uint8_t worstIsr;
+    uint32_t worstState;
+} trace_t;
+
+typedef struct
+{
+    uint8_t bits[BITS_MAX / 8];
+    uint32_t count;
+    uint64_t worst;
+    uint32_t worstBit;
+    uint8_t worstIsr;
+    uint32_t worstState;
+} input_t;
+
+static trace_t* _trace;
+static uint8_t _tracing;
+static uintptr_t _previous;
+static uint64_t _blocks;
+
+static uint8_t _seen[MAP_SIZE];
+static input_t _corpus[CORPUS_SIZE];
+static uint32_t _corpusCount;
+static input_t _worst[WORST_SIZE];
+static uint64_t _random;
+static uint32_t _crashes;
+static const char* _dir = "found";
+
+/// Called by the compiler in every basic block of the firmware
+FUZZ_HARNESS void __sanitizer_cov_trace_pc()
+{
+    if(!_tracing)
+        return;
+    uintptr_t pc = (uintptr_t)__builtin_return_address(0);
+    uint8_t* edge = &_trace->edges[((pc ^ _previous) % MAP_SIZE)];
+    if(*edge < 0xff)
+        (*edge)++;
+    _previous = (pc >> 1);
+    _blocks++;
+}
+
+FUZZ_HARNESS uint32_t nextRandom()
+{
+    _random = (_random * 6364136223846793005ULL) + 1442695040888963407ULL;
+    return (uint32_t)(_random >> 33);
+}
+
+FUZZ_HARNESS void consoleSink(const uint8_t node, const unsigned char data)
+{
+}
+
+/// Runs one interrupt and keeps it if it is the longest so far
+FUZZ_HARNESS void measure(void (*isr)(), const uint8_t which, const uint32_t bit)
+{
+    uint32_t state = rFlag;
+    _blocks = 0;
+    isr();
+    if(_blocks <= _trace->worst)
+        return;
+    _trace->worst = _blocks;
+    _trace->worstBit = bit;
+    _trace->worstIsr = which;
+    _trace->worstState = state;
+}
+
+/// Child - a fresh firmware gets the stream, data first and the clock edge after it like the transmitter
+FUZZ_HARNESS void feed(const input_t* in)
+{
+    halRealTime = 0;
+    halUartTx = consoleSink;
+    io_setup();
+    pin_change_setup();
+    linkInit();
+    _tracing = 1;
+    for(uint32_t i=0; i<in->count; i++)
+    {
+        halIn = (halIn & HAL_PIN_CLOCK) | (BITS_GET(in->bits, i) ? HAL_PIN_DATA : 0);
+        halIn ^= HAL_PIN_CLOCK;
+        measure(halPinChange, ISR_PCINT, i);
+        for(uint32_t t=0; t<BIT_TICKS; t++)
+        {
+            measure(halTimerB, ISR_COMPB, i);
+            measure(halTimerA, ISR_COMPA, i);
+        }
+    }
+}
+
+/// Runs an input in a child process, returns 1 if it reached an edge or a bucket of hits not seen before
+FUZZ_HARNESS int execute(input_t* in)
+{
+    memset(_trace, 0, sizeof(trace_t));
+    pid_t pid = fork();
+    if(pid == 0)
+    {
+        feed(in);
+        _exit(0);
+    }
+    int status;
+    waitpid(pid, &status, 0);
+    if(WIFSIGNALED(status))
+    {
+        char path[256];
+        snprintf(path, sizeof(path), "%s/crash_%u.bits", _dir, ++_crashes);
+        mkdir(_dir, 0755);
+        bitsWrite(path, in->bits, in->count, "the firmware crashed", 0);
+        fprintf(stderr, "signal %d, input written to %s\n", WTERMSIG(status), path);
+    }
+    in->worst = _trace->worst;
+    in->worstBit = _trace->worstBit;
+    in->worstIsr = _trace->worstIsr;
+    in->worstState = _trace->worstState;
+
+    int fresh = 0;
+    for(uint32_t i=0; i<MAP_SIZE; i++)
+    {
+        uint8_t hits = _trace->edges[i];
+        if(!hits)
+            continue;
+        uint8_t bucket = (hits < 4) ? hits : (hits < 8) ? 4 : (hits < 16) ? 8 : (hits < 32) ? 16 : (hits < 128) ? 32 : 64;
+        if(!(_seen[i] & bucket))
+        {
+            _seen[i] |= bucket;
+            fresh = 1;
+        }
+    }
+    return fresh;
+}
+
+/// Keeps the longest interrupts, one input per interrupt and state of the receiver it started in
+FUZZ_HARNESS void rank(const input_t* in)
+{
+    uint32_t slot = WORST_SIZE;
+    for(uint32_t i=0; i<WORST_SIZE; i++)
+    {
+        if(_worst[i].count && (_worst[i].worstIsr == in->worstIsr) && (_worst[i].worstState == in->worstState))
+        {
+            slot = i;
+            break;
+        }
+    }
+    if(slot == WORST_SIZE)
+        slot = (WORST_SIZE - 1);
+    if(in->worst <= _worst[slot].worst)
+        return;
+    _worst[slot] = *in;
+    for(uint32_t i=slot; (i > 0) && (_worst[i].worst > _worst[i - 1].worst); i--)
+    {
+        input_t swap = _worst[i];
+        _worst[i] = _worst[i - 1];
+        _worst[i - 1] = swap;
+    }
+}
+
+FUZZ_HARNESS void setBit(input_t* in, const uint32_t pos, const uint8_t bit)
+{
+    if(bit)
+        in->bits[(pos / 8)] |= (0x80 >> (pos % 8));
+    else
+        in->bits[(pos / 8)] &= ~(0x80 >> (pos % 8));
+}
+
+/// Appends bits the way the transmitter of interrupt.c puts them on the wire
+FUZZ_HARNESS void appendFrame(input_t* in, const uint8_t dst, const uint8_t dlc)
+{
+    frame_t frame;
+    clearFrame(&frame);
+    SET_LENGTH(&frame, dlc);
+    for(uint32_t i=HDR_SIZE; i<dlc; i++)
+        frame.payload[i] = (uint8_t)nextRandom();
+    frame.payload[HDR_DST] = dst;
+    frame.payload[HDR_SRC] = OTHER_ID;
+#if USE_TTL
+    frame.payload[HDR_TTL] = ttlStart;
+#endif
+    makeCrc(frame.crc, frame.payload, dlc, _polynomial, GENERATE);
+
+    for(uint32_t i=0; i<8; i++)
+        setBit(in, in->count++, readBit(_preamble, i));
+    for(uint32_t i=0; i<(4*CODE_BITS); i++)
+        setBit(in, in->count++, readCodeBit(frame.crc, i));
+    for(uint32_t i=0; i<(DLC_BYTES(0)*CODE_BITS); i++)
+        setBit(in, in->count++, readCodeBit((frame.dlc + (DLC_SIZE - DLC_BYTES(0))), i));
+    for(uint32_t i=0; i<(dlc*CODE_BITS); i++)
+        setBit(in, in->count++, readCodeBit(frame.payload, i));
+    for(uint32_t i=0; i<4; i++)
+        setBit(in, in->count++, 0);
+}
+
+/// One to eight random changes - bit and byte flips, random bytes, cut, copied and spliced ranges
+FUZZ_HARNESS void mutate(input_t* in)
+{
+    uint32_t changes = 1 + (nextRandom() % 8);
+    for(uint32_t c=0; c<changes; c++)
+    {
+        if(!in->count)
+            in->count = 1 + (nextRandom() % 64);
+        uint32_t pos = nextRandom() % in->count;
+        uint32_t length = 1 + (nextRandom() % 64);
+        switch(nextRandom() % 6)
+        {
+            case 0:
+                setBit(in, pos, !BITS_GET(in->bits, pos));
+                break;
+            case 1:
+                in->bits[(pos / 8)] ^= 0xff;
+                break;
+            case 2:
+                in->bits[(pos / 8)] = (uint8_t)nextRandom();
+                break;
+            case 3:
+                // Cuts a range out
+                if((pos + length) > in->count)
+                    length = (in->count - pos);
+                for(uint32_t i=pos; (i + length) < in->count; i++)
+                    setBit(in, i, BITS_GET(in->bits, (i + length)));
+                in->count -= length;
+                break;
+            case 4:
+                // Repeats a range behind itself
+                if((pos + length) > in->count)
+                    length = (in->count - pos);
+                if((in->count + length) > BITS_MAX)
+                    break;
+                for(uint32_t i=(in->count + length - 1); i>=(pos + length); i--)
+                    setBit(in, i, BITS_GET(in->bits, (i - length)));
+                in->count += length;
+                break;
+            case 5:
+                // Takes the tail of another input
+                {
+                    input_t* other = &_corpus[nextRandom() % _corpusCount];
+                    uint32_t from = nextRandom() % (other->count + 1);
+                    for(uint32_t i=from; (i < other->count) && ((pos + i - from) < BITS_MAX); i++)
+                        setBit(in, (pos + i - from), BITS_GET(other->bits, i));
+                    if((pos + other->count - from) > in->count)
+                        in->count = ((pos + other->count - from) > BITS_MAX) ? BITS_MAX : (pos + other->count - from);
+                }
+                break;
+        }
+    }
+}
+
+FUZZ_HARNESS void describe(const input_t* in, char* text, const size_t size)
+{
+    snprintf(text, size, "%s at bit %u of %u, rFlag %u before it", _isrNames[in->worstIsr], in->worstBit,
+             in->count, in->worstState);
+}
+
+FUZZ_HARNESS int replay(int argc, char** argv, const double tolerance)
+{
+    int worse = 0;
+    printf("%-32s%12s%12s  %s\n", "INPUT", "RECORDED", "BLOCKS", "INTERRUPT");
+    for(int i=0; i<argc; i++)
+    {
+        input_t in;
+        uint64_t recorded;
+        char text[128];
+        memset(&in, 0, sizeof(in));
+        in.count = bitsRead(argv[i], in.bits, &recorded);
+        if(!in.count)
+        {
+            fprintf(stderr, "cannot read %s\n", argv[i]);
+            return 1;
+        }
+        execute(&in);
+        describe(&in, text, sizeof(text));
+        int regression = (recorded && (in.worst > (recorded * (1.0 + tolerance))));
+        printf("%-32s%12llu%12llu  %s%s\n", argv[i], (unsigned long long)recorded, (unsigned long long)in.worst,
+               text, regression ? "  WORSE" : "");
+        worse |= regression;
+    }
+    return worse;
+}
+
+FUZZ_HARNESS int main(int argc, char** argv)
+{
+    double seconds = 60.0;
+    double tolerance = 0.05;
+    int files = 0;
+    _random = 1;
+
+    _trace = mmap(0, sizeof(trace_t), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if(_trace == MAP_FAILED)
+    {
+        perror("mmap");
+        return 1;
+    }
+    for(int i=1; i<argc; i++)
+    {
+        if(!strcmp(argv[i], "-t") && ((i + 1) < argc))
+            seconds = atof(argv[++i]);
+        else if(!strcmp(argv[i], "-s") && ((i + 1) < argc))
+            _random = strtoull(argv[++i], 0, 10);
+        else if(!strcmp(argv[i], "-o") && ((i + 1) < argc))
+            _dir = argv[++i];
+        else if(!strcmp(argv[i], "-p") && ((i + 1) < argc))
+            tolerance = atof(argv[++i]) / 100.0;
+        else if(!strcmp(argv[i], "-r"))
+            files = i + 1;
+    }
+    if(files)
+    {
+        int count = 0;
+        while(((files + count) < argc) && strcmp(argv[files + count], "-p"))
+            count++;
+        return replay(count, &argv[files], tolerance);
+    }
+
+    // Seeds - frames of every size for this node, one relayed, one broadcast, and noise
+    const uint8_t sizes[5] = { HDR_SIZE, 16, 64, 128, LEGACY_PAYLOAD };
+    for(uint32_t s=0; s<5; s++)
+        appendFrame(&_corpus[_corpusCount++], MY_ID, sizes[s]);
+    appendFrame(&_corpus[_corpusCount++], OTHER_ID, 32);
+    appendFrame(&_corpus[_corpusCount++], BROADCAST_ID, 32);
+    appendFrame(&_corpus[_corpusCount], MY_ID, 8);
+    appendFrame(&_corpus[_corpusCount++], MY_ID, 8);
+    input_t* noise = &_corpus[_corpusCount++];
+    noise->count = 512;
+    for(uint32_t i=0; i<(noise->count / 8); i++)
+        noise->bits[i] = (uint8_t)nextRandom();
+    for(uint32_t i=0; i<_corpusCount; i++)
+    {
+        execute(&_corpus[i]);
+        rank(&_corpus[i]);
+    }
+
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    uint64_t runs = 0;
+    double elapsed = 0.0;
+    while(elapsed < seconds)
+    {
+        // Longer interrupts get picked more often
+        input_t* parent = &_corpus[nextRandom() % _corpusCount];
+        input_t* other = &_corpus[nextRandom() % _corpusCount];
+        if(other->worst > parent->worst)
+            parent = other;
+        input_t child = *parent;
+        mutate(&child);
+        int fresh = execute(&child);
+        runs++;
+        if((fresh || (child.worst > _worst[0].worst)) && (_corpusCount < CORPUS_SIZE))
+            _corpus[_corpusCount++] = child;
+        rank(&child);
+
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+        elapsed = (t1.tv_sec - t0.tv_sec) + ((t1.tv_nsec - t0.tv_nsec) / 1e9);
+    }
+
+    uint32_t edges = 0;
+    for(uint32_t i=0; i<MAP_SIZE; i++)
+        edges += (_seen[i] != 0);
+    printf("%llu runs in %.0f s, %u inputs, %u edges, %u crashes\n\n", (unsigned long long)runs, elapsed,
+           _corpusCount, edges, _crashes);
+    printf("%-4s%12s  %s\n", "RANK", "BLOCKS", "INTERRUPT");
+    mkdir(_dir, 0755);
+    for(uint32_t i=0; i<WORST_SIZE; i++)
+    {
+        input_t* w = &_worst[i];
+        if(!w->count)
+            continue;
+        char text[128], path[256];
+        w->count = (w->worstBit + 1);
+        describe(w, text, sizeof(text));
+        printf("%-4u%12llu  %s\n", i + 1, (unsigned long long)w->worst, text);
+        snprintf(path, sizeof(path), "%s/isr_%u.bits", _dir, i + 1);
+        if(!bitsWrite(path, w->bits, w->count, text, w->worst))
+            fprintf(stderr, "cannot write %s\n", path);
+    }
+    return 0;
+}
@@ -0,0 +1,70 @@
+/*!
+  * \brief      Host benchmark of bulk transfers with legacy frames against jumbo frames of USE_JUMBO
+  * \details    A message is cut into fragments (fragment.c) of the largest payload the link takes.
+  *             Every frame pays preamble, crc, DLC, addresses and the fragment header.
+  *             With bit errors a broken frame is sent again until it arrives, like an ARQ would do.
+  *             Only the payloads frame.h allows are measured - LEGACY_PAYLOAD and JUMBO_PAYLOAD of this build.
+  *             Usage: ./jumbo_bench [ber] */
+#include <stdio.h>
+#include <stdlib.h>
+#include "link.c"
+#include "../src/frame.h"
+
+#define PREAMBLE_BITS   8
+#define CRC_BITS        32
+/// Addresses and fragment header
+#define HEADER_BYTES    5
+
+/// Bits on the wire to deliver "length" bytes with frames of at most "payload" bytes
+uint64_t transfer(const uint32_t length, const uint32_t payload, const double ber)
+{
+    const uint32_t chunk = payload - HEADER_BYTES;
+    const uint32_t dlcBits = (payload > LEGACY_PAYLOAD) ? 16 : 8;
+    uint64_t bits = 0;
+
+    for(uint32_t offset=0; offset<length; offset+=chunk)
+    {
+        uint32_t size = ((length - offset) > chunk) ? chunk : (length - offset);
+        uint32_t frameBits = PREAMBLE_BITS + CRC_BITS + dlcBits + ((HEADER_BYTES + size) * 8);
+        for(;;)
+        {
+            bits += frameBits;
+            uint8_t ok = 1;
+            for(uint32_t i=0; (i<frameBits) && ok; i++)
+                ok = !linkError(ber);
+            if(ok)
+                break;
+        }
+    }
+    return bits;
+}
+
+int main(int argc, char** argv)
+{
+    const double ber = (argc > 1) ? atof(argv[1]) : 0.0;
+    const uint32_t lengths[4] = { 1024, 4096, 16384, 32767 };
+    const uint32_t payloads[2] = { LEGACY_PAYLOAD, JUMBO_PAYLOAD };
+
+    linkSeed(1);
+    printf("bulk transfer goodput (message bits per wire bit), BER %g\n\n", ber);
+    printf("%-8s", "MESSAGE");
+    for(int p=0; p<2; p++)
+        printf("  %s%-5u", (p == 0) ? "LEGACY " : "JUMBO ", payloads[p]);
+    printf("\n");
+
+    for(int l=0; l<4; l++)
+    {
+        printf("%-8u", lengths[l]);
+        for(int p=0; p<2; p++)
+        {
+            // Average of several transfers once bit errors make it random
+            const uint32_t runs = (ber > 0.0) ? 20 : 1;
+            uint64_t bits = 0;
+            for(uint32_t r=0; r<runs; r++)
+                bits += transfer(lengths[l], payloads[p], ber);
+            printf("  %12.4f", ((double)lengths[l] * 8 * runs) / bits);
+        }
+        printf("\n");
+    }
+    return 0;
+}
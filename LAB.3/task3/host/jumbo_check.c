@@ -0,0 +1,130 @@
+/*!
+  * \brief      Checks the receiver of USE_JUMBO on a line that idles high between frames
+  * \details    Built from the firmware with the POSIX backend and USE_JUMBO, the harness feeds the receiver one
+  *             clock edge per bit like isr_fuzz does. A long run of idle 1 bits must not lock it onto a preamble,
+  *             and legacy and jumbo frames for this node, back to back or with idle gaps of random length in
+  *             between, must all arrive. Both preambles are also checked against every bit pattern that can lead into them.
+  *             Usage: ./jumbo_check */
+#include <stdio.h>
+#include <stdlib.h>
+#include "../src/interrupt.c"
+
+#if !USE_JUMBO
+#error "jumbo_check needs -DUSE_JUMBO=1"
+#endif
+
+#define FRAMES          64
+
+static uint32_t _failed;
+static uint32_t _delivered;
+
+void expect(const int ok, const char* what)
+{
+    printf("%-6s%s\n", ok ? "OK" : "FAIL", what);
+    if(!ok)
+        _failed++;
+}
+
+void consoleSink(const uint8_t node, const unsigned char data)
+{
+}
+
+void onFrame(const frame_t* frame)
+{
+    _delivered++;
+}
+
+/// One clock edge with its data bit, then the timer ticks of one bit time
+void edge(const uint8_t bit)
+{
+    halIn = (halIn & HAL_PIN_CLOCK) | (bit ? HAL_PIN_DATA : 0);
+    halIn ^= HAL_PIN_CLOCK;
+    halPinChange();
+    for(uint32_t t=0; t<BIT_TICKS; t++)
+        halTimerB();
+}
+
+/// The line keeps the level of the last bit between frames
+void idle(const uint32_t bits, const uint8_t level)
+{
+    for(uint32_t i=0; i<bits; i++)
+        edge(level);
+}
+
+/// A frame for this node the way the transmitter of interrupt.c puts it on the wire
+void frame(const uint16_t dlc)
+{
+    frame_t f;
+    uint8_t jumbo = (dlc > LEGACY_PAYLOAD);
+    clearFrame(&f);
+    SET_LENGTH(&f, dlc);
+    for(uint32_t i=HDR_SIZE; i<dlc; i++)
+        f.payload[i] = (uint8_t)rand();
+    f.payload[HDR_DST] = MY_ID;
+    f.payload[HDR_SRC] = OTHER_ID;
+    makeCrc(f.crc, f.payload, dlc, _polynomial, GENERATE);
+
+    for(uint32_t i=0; i<8; i++)
+        edge(readBit((jumbo ? _jumboPreamble : _preamble), i));
+    for(uint32_t i=0; i<(4*CODE_BITS); i++)
+        edge(readCodeBit(f.crc, i));
+    for(uint32_t i=0; i<(DLC_BYTES(jumbo)*CODE_BITS); i++)
+        edge(readCodeBit((f.dlc + (DLC_SIZE - DLC_BYTES(jumbo))), i));
+    for(uint32_t i=0; i<(dlc*CODE_BITS); i++)
+        edge(readCodeBit(f.payload, i));
+}
+
+/// 1 if "preamble" shows up in the shift register before all bits of "lead" went in - the register holds
+/// RX_QUEUE_RESET after every preamble, then idle bits of one level - 1s leave it alone, 0s shift in
+uint8_t buildsFrom(const uint8_t preamble, const uint8_t lead)
+{
+    for(uint8_t zeros=0; zeros<=8; zeros++)
+    {
+        uint8_t reg = (uint8_t)(RX_QUEUE_RESET << zeros);
+        for(uint8_t i=0; i<8; i++)
+        {
+            reg = (uint8_t)((reg << 1) | ((lead >> (7 - i)) & 0x01));
+            if((reg == preamble) && (i < 7))
+                return 0x01;
+        }
+    }
+    return 0x00;
+}
+
+int main()
+{
+    halRealTime = 0;
+    halUartTx = consoleSink;
+    linkInit();
+    linkOnFrame = onFrame;
+    srand(1);
+
+    // Idle bits of either level after a frame and after a zeroed shift register
+    idle(2000, 1);
+    expect((rFlag == FLAG_DETECTING_PREAMBLE) && (stats.rxOversize == 0), "2000 idle 1 bits lock onto nothing");
+    *rQueue = 0;
+    idle(2000, 1);
+    expect((rFlag == FLAG_DETECTING_PREAMBLE) && (stats.rxOversize == 0), "neither do they after a zeroed register");
+
+    // Every preamble has to end in 0, and neither may appear early in the bits that lead into the other
+    expect(!(JUMBO_PREAMBLE & 0x01) && !(*_preamble & 0x01), "both preambles end in 0");
+    expect(!buildsFrom(JUMBO_PREAMBLE, *_preamble) && !buildsFrom(*_preamble, JUMBO_PREAMBLE)
+           && !buildsFrom(JUMBO_PREAMBLE, 0xff) && !buildsFrom(*_preamble, 0xff)
+           && !buildsFrom(JUMBO_PREAMBLE, 0x00) && !buildsFrom(*_preamble, 0x00),
+           "no preamble inside the other one or a run of idle bits");
+
+    // Legacy and jumbo frames back to back and with idle gaps of random length and level
+    for(uint32_t i=0; i<FRAMES; i++)
+    {
+        if(i % 3)
+            idle(1 + (rand() % 40), (i & 1));
+        frame((i % 4) ? (HDR_SIZE + (rand() % 32)) : (LEGACY_PAYLOAD + 1 + (rand() % (FRAME_PAYLOAD - LEGACY_PAYLOAD))));
+    }
+    idle(16, 1);
+    expect((_delivered == FRAMES) && (stats.rxOversize == 0), "64 of 64 legacy and jumbo frames back to back and between idle gaps arrive");
+    if(_delivered != FRAMES)
+        printf("      %u delivered, rxOversize %u\n", _delivered, (unsigned)stats.rxOversize);
+
+    printf("\n%s\n", _failed ? "JUMBO CHECK FAILED" : "JUMBO CHECK PASSED");
+    return _failed ? 1 : 0;
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include <time.h>
+#include "link.h"
+
+/// One generator per thread, so simulations may run side by side
+__thread uint64_t _linkState = 0x2545f4914f6cdd1dULL;
+
+void linkSeed(const uint64_t seed)
+{
+    _linkState = (seed != 0) ? seed : 0x2545f4914f6cdd1dULL;
+}
+
+uint32_t linkRandom()
+{
+    _linkState ^= _linkState >> 12;
+    _linkState ^= _linkState << 25;
+    _linkState ^= _linkState >> 27;
+    return (uint32_t)((_linkState * 0x2545f4914f6cdd1dULL) >> 32);
+}
+
+uint8_t linkError(const double ber)
+{
+    if(ber <= 0.0)
+        return 0x00;
+    return ((linkRandom() / 4294967296.0) < ber) ? 0x01 : 0x00;
+}
+
+uint32_t linkTransmit(uint8_t* buffer, const uint32_t bits, const double ber)
+{
+    uint32_t flipped = 0;
+    for(uint32_t i=0; i<bits; i++)
+    {
+        if(linkError(ber))
+        {
+            buffer[(i/8)] ^= (0b10000000 >> (i%8));
+            flipped++;
+        }
+    }
+    return flipped;
+}
+
+uint64_t linkNow()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((uint64_t)now.tv_sec * 1000000000ULL) + now.tv_nsec;
+}
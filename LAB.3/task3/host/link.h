@@ -0,0 +1,34 @@
+#pragma once
+#include <stdint.h>
+
+/// Bit rate of the firmware - 12 MHz / 256 prescaler / 48 (OCR0A) ticks per second, one bit every 3 ticks
+#define LINK_BITRATE    325.5
+
+/*! \brief      Seeds the pseudo random generator of the simulated link
+  * \param      seed    - Any non-zero number, the same seed repeats the same run
+  * \return     void */
+void linkSeed(const uint64_t seed);
+
+
+/*! \brief      Draws the next pseudo random number (xorshift64*)
+  * \return     unsigned 32-bits data */
+uint32_t linkRandom();
+
+
+/*! \brief      Decides whether a bit sent over the link gets flipped
+  * \param      ber     - Bit error rate of the link, 0.0 to 1.0
+  * \return     unsigned 8-bits data - 1(flipped) or 0 */
+uint8_t linkError(const double ber);
+
+
+/*! \brief      Sends a bit string over a binary symmetric channel
+  * \param      buffer  - Set of bits, which gets the injected errors in place
+  * \param      bits    - Amount of bits to be sent
+  * \param      ber     - Bit error rate of the link, 0.0 to 1.0
+  * \return     unsigned 32-bits data - Amount of flipped bits */
+uint32_t linkTransmit(uint8_t* buffer, const uint32_t bits, const double ber);
+
+
+/*! \brief      Returns a monotonic timestamp for benchmarks
+  * \return     unsigned 64-bits data - Nanoseconds */
+uint64_t linkNow();
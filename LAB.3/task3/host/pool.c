@@ -0,0 +1,113 @@
+#pragma once
+#include <stdio.h>
+#include <stdlib.h>
+#include "pool.h"
+
+typedef struct
+{
+    pool_deque_t* deques;
+    uint32_t workers;
+    uint32_t self;
+    pool_task_t task;
+    void* context;
+} pool_worker_t;
+
+/// Takes a task from the back of the own deque
+static uint8_t poolPop(pool_deque_t* d, uint32_t* task)
+{
+    uint8_t found = 0;
+    pthread_mutex_lock(&d->lock);
+    if(d->tail > d->head)
+    {
+        *task = d->tasks[--d->tail];
+        found = 1;
+    }
+    pthread_mutex_unlock(&d->lock);
+    return found;
+}
+
+/// Takes a task from the front of another deque
+static uint8_t poolSteal(pool_deque_t* d, uint32_t* task)
+{
+    uint8_t found = 0;
+    if(pthread_mutex_trylock(&d->lock))
+        return 0;
+    if(d->tail > d->head)
+    {
+        *task = d->tasks[d->head++];
+        found = 1;
+    }
+    pthread_mutex_unlock(&d->lock);
+    return found;
+}
+
+static void* poolWorker(void* arg)
+{
+    pool_worker_t* w = arg;
+    pool_deque_t* own = &w->deques[w->self];
+    uint32_t task;
+    for(;;)
+    {
+        while(poolPop(own, &task))
+            w->task(task, w->self, w->context);
+
+        // Victims in turn from the next worker on, the locks of busy deques are only tried
+        uint8_t found = 0, busy = 0;
+        for(uint32_t i=1; (i<w->workers) && !found; i++)
+        {
+            pool_deque_t* victim = &w->deques[((w->self + i) % w->workers)];
+            found = poolSteal(victim, &task);
+            busy |= (!found && (victim->tail > victim->head));
+        }
+        if(found)
+        {
+            own->stolen++;
+            w->task(task, w->self, w->context);
+        }
+        else if(!busy)
+            return 0;
+    }
+}
+
+uint64_t poolRun(const uint32_t tasks, const uint32_t workers, pool_task_t task, void* context)
+{
+    if((workers < 1) || (workers > POOL_MAX_WORKERS))
+    {
+        fprintf(stderr, "workers 1 to %u\n", POOL_MAX_WORKERS);
+        exit(1);
+    }
+
+    pool_deque_t* deques = calloc(workers, sizeof(pool_deque_t));
+    pool_worker_t* threads = calloc(workers, sizeof(pool_worker_t));
+    pthread_t* ids = calloc(workers, sizeof(pthread_t));
+    uint32_t* order = malloc(sizeof(uint32_t) * (tasks ? tasks : 1));
+    for(uint32_t t=0; t<tasks; t++)
+        order[t] = t;
+
+    // Contiguous blocks, the owner starts at the end of its block
+    for(uint32_t w=0; w<workers; w++)
+    {
+        deques[w].tasks = order;
+        deques[w].head = (uint32_t)(((uint64_t)tasks * w) / workers);
+        deques[w].tail = (uint32_t)(((uint64_t)tasks * (w + 1)) / workers);
+        pthread_mutex_init(&deques[w].lock, 0);
+        threads[w] = (pool_worker_t){ deques, workers, w, task, context };
+    }
+    for(uint32_t w=1; w<workers; w++)
+        pthread_create(&ids[w], 0, poolWorker, &threads[w]);
+    poolWorker(&threads[0]);
+
+    uint64_t stolen = deques[0].stolen;
+    for(uint32_t w=1; w<workers; w++)
+    {
+        pthread_join(ids[w], 0);
+        stolen += deques[w].stolen;
+    }
+    for(uint32_t w=0; w<workers; w++)
+        pthread_mutex_destroy(&deques[w].lock);
+    free(order);
+    free(ids);
+    free(threads);
+    free(deques);
+    return stolen;
+}
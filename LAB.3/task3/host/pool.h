@@ -0,0 +1,33 @@
+#pragma once
+#include <stdint.h>
+#include <pthread.h>
+
+/* Work-Stealing Pool
+ * The tasks 0 to n-1 are split into one block per worker. A worker takes its own tasks from the back
+ * of its deque and, once it ran dry, steals from the front of the others, so long and short
+ * simulations even out without a shared queue. No task makes new ones, so a worker stops after
+ * a round in which it found nothing to steal. */
+
+/// Largest number of workers
+#define POOL_MAX_WORKERS    256
+
+/// Task callback - "worker" tells which per-thread resources, e.g. an arena, the task may use
+typedef void (*pool_task_t)(const uint32_t task, const uint32_t worker, void* context);
+
+/// Deque of one worker - the owner works at "tail", thieves at "head"
+typedef struct
+{
+    uint32_t* tasks;
+    uint32_t head, tail;
+    pthread_mutex_t lock;
+    uint64_t stolen;
+} pool_deque_t;
+
+
+/*! \brief      Runs every task once on a number of threads and waits for all of them
+  * \param      tasks   - Number of tasks
+  * \param      workers - Number of threads, 1 to POOL_MAX_WORKERS
+  * \param      task    - Callback for every task
+  * \param      context - Handed to every callback
+  * \return     unsigned 64-bits data - Tasks that were stolen from another worker */
+uint64_t poolRun(const uint32_t tasks, const uint32_t workers, pool_task_t task, void* context);
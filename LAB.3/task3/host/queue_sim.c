@@ -0,0 +1,176 @@
+/*!
+  * \brief      Host simulation of the transmit arbiter of USE_QUEUE
+  * \details    One node with a relay queue and a local queue in front of its transmitter.
+  *             Frames of both classes arrive at random with random payload sizes. A full queue drops
+  *             the arriving frame, like the relay queue of the firmware does.
+  *             Every arbiter runs on the same arrivals - relay-heavy, balanced and local-heavy mixes.
+  *             Usage: ./queue_sim [queue slots] */
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "link.c"
+
+#define PREAMBLE_BITS   8
+#define CRC_BITS        32
+#define DLC_BITS        8
+#define FRAMES          20000
+#define MAX_SLOTS       64
+#define QUANTUM         64
+
+#define STRICT_RELAY    0
+#define STRICT_LOCAL    1
+#define DRR             2
+
+typedef struct
+{
+    uint64_t time[MAX_SLOTS];
+    uint32_t size[MAX_SLOTS];
+    uint32_t head, count;
+    int32_t deficit;
+    uint64_t sent, wait, waitMax, dropped;
+} class_t;
+
+typedef struct
+{
+    double time;
+    uint8_t c;
+    uint32_t size;
+} arrival_t;
+
+static arrival_t _arrivals[2*FRAMES];
+
+/// Merged arrivals of both classes, "load" in frames per bit time
+uint32_t makeArrivals(const double relayLoad, const double localLoad)
+{
+    // Both classes over the same span of time, FRAMES arrivals on average
+    const double span = FRAMES / (relayLoad + localLoad);
+    const double load[2] = { relayLoad, localLoad };
+    double t[2] = { 0.0, 0.0 };
+    uint32_t count = 0;
+
+    while(count < (2*FRAMES))
+    {
+        uint8_t c = (t[0] > t[1]);
+        double u = ((double)linkRandom() + 1.0) / 4294967297.0;
+        t[c] += -log(u) / load[c];
+        if(t[c] > span)
+        {
+            if(t[(c ^ 1)] > span)
+                break;
+            continue;
+        }
+        _arrivals[count].time = t[c];
+        _arrivals[count].c = c;
+        _arrivals[count].size = 8 + (linkRandom() % 120);
+        count++;
+    }
+    // Drawn in nearly merged order, insertion fixes the rest
+    for(uint32_t i=1; i<count; i++)
+    {
+        arrival_t a = _arrivals[i];
+        uint32_t j = i;
+        while((j > 0) && (_arrivals[(j-1)].time > a.time))
+        {
+            _arrivals[j] = _arrivals[(j-1)];
+            j--;
+        }
+        _arrivals[j] = a;
+    }
+    return count;
+}
+
+/// Class of the next frame like queuePick, or 2 if both are empty
+uint8_t pick(class_t* q, const uint8_t arbiter, uint8_t* turn)
+{
+    if(!q[0].count && !q[1].count)
+        return 2;
+    if(arbiter == STRICT_RELAY)
+        return q[0].count ? 0 : 1;
+    if(arbiter == STRICT_LOCAL)
+        return q[1].count ? 1 : 0;
+    for(;;)
+    {
+        uint8_t c = *turn;
+        if(!q[c].count)
+            q[c].deficit = 0;
+        else if((int32_t)q[c].size[q[c].head] <= q[c].deficit)
+            return c;
+        *turn ^= 1;
+        q[*turn].deficit += QUANTUM;
+    }
+}
+
+void run(const uint32_t count, const uint8_t arbiter, const uint32_t slots, class_t* q)
+{
+    uint64_t now = 0;
+    uint32_t next = 0;
+    uint8_t turn = 0;
+
+    for(int c=0; c<2; c++)
+        q[c] = (class_t){ .head = 0 };
+
+    while((next < count) || q[0].count || q[1].count)
+    {
+        while((next < count) && ((uint64_t)_arrivals[next].time <= now))
+        {
+            class_t* k = &q[_arrivals[next].c];
+            if(k->count >= slots)
+                k->dropped++;
+            else
+            {
+                uint32_t tail = (k->head + k->count) % MAX_SLOTS;
+                k->time[tail] = (uint64_t)_arrivals[next].time;
+                k->size[tail] = _arrivals[next].size;
+                k->count++;
+            }
+            next++;
+        }
+
+        uint8_t c = pick(q, arbiter, &turn);
+        if(c > 1)
+        {
+            now = (uint64_t)_arrivals[next].time + 1;
+            continue;
+        }
+
+        class_t* k = &q[c];
+        uint32_t size = k->size[k->head];
+        uint64_t wait = now - k->time[k->head];
+        if(arbiter == DRR)
+            k->deficit -= size;
+        k->head = (k->head + 1) % MAX_SLOTS;
+        k->count--;
+        k->sent++;
+        k->wait += wait;
+        if(wait > k->waitMax)
+            k->waitMax = wait;
+        now += PREAMBLE_BITS + CRC_BITS + DLC_BITS + (size * 8);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const uint32_t slots = (argc > 1) ? atoi(argv[1]) : 8;
+    const char* names[3] = { "STRICT RELAY", "STRICT LOCAL", "DRR" };
+    // Frames per bit time - a frame takes about 560 bit times, so 1/560 fills the link
+    const double mixes[3][2] = { { 1.0/700, 1.0/5000 }, { 1.0/1100, 1.0/1100 }, { 1.0/5000, 1.0/700 } };
+    const char* mixNames[3] = { "relay-heavy", "balanced", "local-heavy" };
+
+    linkSeed(1);
+    printf("transmit arbiter, %u slots per queue, waits in bit times\n", (slots > MAX_SLOTS) ? MAX_SLOTS : slots);
+
+    for(int m=0; m<3; m++)
+    {
+        uint32_t count = makeArrivals(mixes[m][0], mixes[m][1]);
+        printf("\n%s\n%-14s%10s%10s%10s%10s%10s%10s\n", mixNames[m], "ARBITER", "R AVG", "R MAX", "R DROP", "L AVG", "L MAX", "L DROP");
+        for(int a=0; a<3; a++)
+        {
+            class_t q[2];
+            run(count, a, (slots > MAX_SLOTS) ? MAX_SLOTS : slots, q);
+            printf("%-14s%10.0f%10llu%10llu%10.0f%10llu%10llu\n", names[a],
+                   q[0].sent ? (double)q[0].wait / q[0].sent : 0.0, (unsigned long long)q[0].waitMax, (unsigned long long)q[0].dropped,
+                   q[1].sent ? (double)q[1].wait / q[1].sent : 0.0, (unsigned long long)q[1].waitMax, (unsigned long long)q[1].dropped);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,5 @@
+/*!
+  * \brief      Translation unit of libraspnet.a
+  * \details    The firmware without its console - main.c stays on the ATMega, a host program takes its place.
+  *             Built by "make lib" with -DHAL_POSIX=1, see raspnet.h */
+#include "../src/interrupt.c"
@@ -0,0 +1,75 @@
+#pragma once
+#include <stdint.h>
+#include "../src/frame.h"
+
+/* RaspNet Library
+ * Entry points of libraspnet.a, the firmware built with the POSIX backend of src/hal.h.
+ * One library holds one node - it is driven by halTick for every timer period and by halDrive
+ * for every change of its input pins, and its own pins are read from halOut. */
+
+/// Pins of the node, see src/hal_posix.h
+#define HAL_PIN_CLOCK               0x01
+#define HAL_PIN_DATA                0x02
+#define HAL_PIN_CLOCK2              0x04
+#define HAL_PIN_DATA2               0x08
+#define HAL_PIN_READY               0x10
+
+/// Virtual time of one timer period
+#define HAL_TICK_US                 1024
+
+/// Transmitter free, see src/interrupt.h
+#define PRIORITY_IDLE               50
+
+extern volatile uint8_t halOut;
+extern volatile uint8_t halIn;
+
+/// Real-time timer thread, node id and serial port hooks of a node in a virtual ring
+extern volatile uint8_t halRealTime;
+extern volatile uint8_t halNode;
+extern void (*halUartTx)(const uint8_t node, const unsigned char data);
+extern int16_t (*halUartRx)(const uint8_t node);
+
+/// Who owns the transmitter, PRIORITY_IDLE when sendFrame goes out at once
+extern volatile uint32_t pFlag;
+
+/// Free-running tick counter of the clock interrupt
+extern volatile uint32_t ticks;
+
+/// Upper layer callback for every frame delivered to this node
+extern void (*linkOnFrame)(const frame_t* frame);
+
+
+/// Setup of the pins, the timer thread for real-time runs and the pin-change interrupt
+void io_setup();
+void interrupt_setup();
+void pin_change_setup();
+
+
+/*! \brief      Points the frame buffers at their storage and puts the transmitter and the receiver to idle
+  * \return     void */
+void linkInit();
+
+
+/*! \brief      Generates the crc of a frame and hands it over to the transmitter as a local send
+  * \details    Waits until the transmitter is free, so another thread has to keep calling halTick
+  * \param      frame   - Frame to be sent, its crc is overwritten
+  * \return     void */
+void sendFrame(frame_t* frame);
+
+
+/*! \brief      Runs compare match B (the clock interrupt) and compare match A (the transmit interrupt) of the node
+  * \details    Pins passed on between the two keep the data of a bit apart from the clock edge that samples it
+  * \return     void */
+void halCompareB();
+void halCompareA();
+
+
+/*! \brief      Runs one timer period of the node
+  * \return     void */
+void halTick();
+
+
+/*! \brief      Changes the levels of the input pins and runs the receiver if a clock pin moved
+  * \param      pins    - New levels of the input pins, e.g. halOut of the upstream node
+  * \return     void */
+void halDrive(const uint8_t pins);
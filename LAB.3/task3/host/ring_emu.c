@@ -0,0 +1,231 @@
+/*!
+  * \brief      Virtual ring of RaspNet nodes running the actual firmware on Linux
+  * \details    Every node is a copy of src/main.c built with the POSIX backend of src/hal.h and its own MY_ID
+  *             ("make ring NODES=n" builds ring/node1.so to ring/noden.so). The copies are loaded side by side,
+  *             so each one keeps its own frames, flags and statistics, and its console loop runs in a thread.
+  *             One shared virtual tick drives the timer interrupts of all nodes, and the clock and data pins of
+  *             every node are wired to the next one, the second port and the ready line to the previous one.
+  *             Console lines on stdin:
+  *               <id> <keys>   types the keys and Enter into the console of node id, e.g. "1 a3" sends to node 3
+  *               wait <ticks>  waits until the virtual clock went on by that many ticks, for scripts
+  *               quit          ends the emulation, as does the end of stdin
+  *               # ...         comment of a script
+  *             Usage: ./ring_emu [nodes] [real time 1/0] */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <dlfcn.h>
+#include <pthread.h>
+#include "raspnet.h"
+
+#define MAX_NODES       32
+#define CONSOLE_SIZE    256
+#define LINE_SIZE       256
+
+/// Pins of the node ahead of it and of the node behind it
+#define PINS_UPSTREAM   (HAL_PIN_CLOCK | HAL_PIN_DATA)
+#define PINS_DOWNSTREAM (HAL_PIN_CLOCK2 | HAL_PIN_DATA2 | HAL_PIN_READY)
+
+typedef struct
+{
+    void* handle;
+    void (*compareB)();
+    void (*compareA)();
+    void (*drive)(const uint8_t pins);
+    int (*run)();
+    volatile uint8_t* out;
+    volatile uint8_t* pinMask;
+
+    /// Keys typed into the console, one writer and one reader
+    unsigned char keys[CONSOLE_SIZE];
+    volatile uint32_t keyHead, keyTail;
+
+    /// Console output up to the next line feed
+    char line[LINE_SIZE];
+    uint32_t lineLength;
+} node_t;
+
+static node_t _nodes[MAX_NODES];
+static uint32_t _ring;
+static uint8_t _realTime;
+static volatile uint8_t _running = 1;
+static volatile uint64_t _ticks = 0;
+static pthread_mutex_t _print = PTHREAD_MUTEX_INITIALIZER;
+
+/// Serial port of the nodes - node ids run from 1, so the output is tagged with it
+void consoleTx(const uint8_t node, const unsigned char data)
+{
+    node_t* n = &_nodes[node - 1];
+    pthread_mutex_lock(&_print);
+    if((data == '\n') || (n->lineLength == (LINE_SIZE - 1)))
+    {
+        n->line[n->lineLength] = 0;
+        printf("[%u] %s\n", node, n->line);
+        fflush(stdout);
+        n->lineLength = 0;
+    }
+    if((data != '\n') && (data != '\r'))
+        n->line[n->lineLength++] = data;
+    pthread_mutex_unlock(&_print);
+}
+
+int16_t consoleRx(const uint8_t node)
+{
+    node_t* n = &_nodes[node - 1];
+    if(n->keyTail == n->keyHead)
+        return -1;
+    unsigned char data = n->keys[n->keyTail % CONSOLE_SIZE];
+    __sync_synchronize();
+    n->keyTail++;
+    return data;
+}
+
+void consoleType(node_t* n, const char* keys)
+{
+    for(; *keys; keys++)
+    {
+        while((n->keyHead - n->keyTail) >= CONSOLE_SIZE)
+            usleep(1000);
+        n->keys[n->keyHead % CONSOLE_SIZE] = (*keys == '\n') ? '\r' : *keys;
+        __sync_synchronize();
+        n->keyHead++;
+    }
+}
+
+void* nodeMain(void* arg)
+{
+    ((node_t*)arg)->run();
+    return 0;
+}
+
+/// Passes the pins of every node on to its neighbours at once
+void wire()
+{
+    uint8_t pins[MAX_NODES];
+    for(uint32_t i=0; i<_ring; i++)
+        pins[i] = *_nodes[i].out;
+    for(uint32_t i=0; i<_ring; i++)
+    {
+        uint8_t upstream = pins[((i + _ring - 1) % _ring)];
+        uint8_t downstream = pins[((i + 1) % _ring)];
+        _nodes[i].drive((upstream & PINS_UPSTREAM) | (downstream & PINS_DOWNSTREAM));
+    }
+}
+
+/// Shared virtual tick - the clock edges of all nodes go over the wires before the data of the next bit
+void* clockMain(void* arg)
+{
+    struct timespec next;
+    clock_gettime(CLOCK_MONOTONIC, &next);
+    while(_running)
+    {
+        for(uint32_t i=0; i<_ring; i++)
+            _nodes[i].compareB();
+        wire();
+        for(uint32_t i=0; i<_ring; i++)
+            _nodes[i].compareA();
+        wire();
+        _ticks++;
+
+        if(!_realTime)
+            continue;
+        next.tv_nsec += 1024000L;
+        if(next.tv_nsec >= 1000000000L)
+        {
+            next.tv_sec++;
+            next.tv_nsec -= 1000000000L;
+        }
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, 0);
+    }
+    return 0;
+}
+
+/// Loads its own copy of the firmware for every node and hooks up its serial port
+int load(const uint32_t id)
+{
+    char path[64];
+    node_t* n = &_nodes[id - 1];
+    snprintf(path, sizeof(path), "./ring/node%u.so", id);
+    n->handle = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+    if(!n->handle)
+    {
+        fprintf(stderr, "%s\n", dlerror());
+        return 0;
+    }
+
+    n->compareB = (void (*)())dlsym(n->handle, "halCompareB");
+    n->compareA = (void (*)())dlsym(n->handle, "halCompareA");
+    n->drive = (void (*)(const uint8_t))dlsym(n->handle, "halDrive");
+    n->run = (int (*)())dlsym(n->handle, "main");
+    n->out = (volatile uint8_t*)dlsym(n->handle, "halOut");
+    n->pinMask = (volatile uint8_t*)dlsym(n->handle, "halPinMask");
+    volatile uint8_t* realTime = (volatile uint8_t*)dlsym(n->handle, "halRealTime");
+    volatile uint8_t* node = (volatile uint8_t*)dlsym(n->handle, "halNode");
+    void (**tx)(const uint8_t, const unsigned char) = dlsym(n->handle, "halUartTx");
+    int16_t (**rx)(const uint8_t) = dlsym(n->handle, "halUartRx");
+    if(!n->compareB || !n->compareA || !n->drive || !n->run || !n->out || !n->pinMask || !realTime || !node || !tx || !rx)
+    {
+        fprintf(stderr, "%s is not a POSIX build of the firmware\n", path);
+        return 0;
+    }
+
+    *realTime = 0;
+    *node = id;
+    *tx = consoleTx;
+    *rx = consoleRx;
+    return 1;
+}
+
+int main(int argc, char** argv)
+{
+    _ring = (argc > 1) ? atoi(argv[1]) : 8;
+    _realTime = (argc > 2) ? atoi(argv[2]) : 1;
+    if((_ring < 2) || (_ring > MAX_NODES))
+    {
+        fprintf(stderr, "ring size 2 to %u\n", MAX_NODES);
+        return 1;
+    }
+
+    pthread_t thread;
+    for(uint32_t id=1; id<=_ring; id++)
+    {
+        if(!load(id))
+            return 1;
+        pthread_create(&thread, 0, nodeMain, &_nodes[id - 1]);
+        pthread_detach(thread);
+    }
+
+    // The interrupts start once every node set up its frames and its pin-change interrupt
+    for(uint32_t i=0; i<_ring; i++)
+        while(!(*_nodes[i].pinMask & HAL_PIN_CLOCK))
+            usleep(1000);
+    pthread_t clock;
+    pthread_create(&clock, 0, clockMain, 0);
+    printf("ring of %u nodes, ids 1 to %u\n", _ring, _ring);
+    fflush(stdout);
+
+    char input[LINE_SIZE];
+    while(fgets(input, sizeof(input), stdin))
+    {
+        char* keys = 0;
+        unsigned long value = strtoul(input, &keys, 10);
+        if(!strncmp(input, "quit", 4))
+            break;
+        if(!strncmp(input, "wait", 4))
+        {
+            uint64_t until = _ticks + strtoul(&input[4], 0, 10);
+            while(_ticks < until)
+                usleep(1000);
+        }
+        else if((keys != input) && (value >= 1) && (value <= _ring))
+            consoleType(&_nodes[value - 1], (*keys == ' ') ? (keys + 1) : keys);
+        else if((input[0] != '\n') && (input[0] != '#'))
+            fprintf(stderr, "<id> <keys>, wait <ticks> or quit\n");
+    }
+
+    _running = 0;
+    pthread_join(clock, 0);
+    return 0;
+}
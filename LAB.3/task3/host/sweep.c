@@ -0,0 +1,216 @@
+/*!
+  * \brief      Parallel sweep of capacity_sim scenarios over a parameter grid
+  * \details    Every point of the grid is one independent simulation of capacity.c. The points run on a work-stealing
+  *             pool with one arena per thread, so a simulation never calls malloc and threads share nothing but
+  *             their deques. Each result goes into its own slot of one array, the report is written from it in
+  *             grid order once all threads are done - the output does not depend on the number of threads.
+  *             Grid dimensions are given as name=v1,v2,... and default to one value:
+  *               nodes=50,200,255 payload=32 bitrate=325.5 ber=0 load=0.5 queue=4 cut=0 broadcast=0 hours=1 seed=1
+  *             Usage: ./sweep [-j threads] [-f csv|json] [-o file] [name=v1,v2,... ...] */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "capacity.c"
+#include "pool.c"
+
+#define DIMENSIONS      10
+#define MAX_VALUES      64
+
+/// One dimension of the grid
+typedef struct
+{
+    const char* name;
+    double values[MAX_VALUES];
+    uint32_t count;
+} dimension_t;
+
+typedef struct
+{
+    dimension_t dims[DIMENSIONS];
+    uint32_t points;
+    capacity_params_t* params;
+    capacity_result_t* results;
+    arena_t* arenas;
+} sweep_t;
+
+static sweep_t _sweep =
+{
+    .dims =
+    {
+        { "nodes", { 50, 200, 255 }, 3 },
+        { "payload", { 32 }, 1 },
+        { "bitrate", { LINK_BITRATE }, 1 },
+        { "ber", { 0 }, 1 },
+        { "load", { 0.5 }, 1 },
+        { "queue", { 4 }, 1 },
+        { "cut", { 0 }, 1 },
+        { "broadcast", { 0 }, 1 },
+        { "hours", { 1 }, 1 },
+        { "seed", { 1 }, 1 },
+    }
+};
+
+/// Reads "name=v1,v2,..." into its dimension
+int parseDimension(const char* arg)
+{
+    const char* eq = strchr(arg, '=');
+    if(!eq)
+        return 0;
+    for(uint32_t d=0; d<DIMENSIONS; d++)
+    {
+        dimension_t* dim = &_sweep.dims[d];
+        if((strlen(dim->name) != (size_t)(eq - arg)) || strncmp(arg, dim->name, (eq - arg)))
+            continue;
+        dim->count = 0;
+        const char* p = eq + 1;
+        while(*p && (dim->count < MAX_VALUES))
+        {
+            char* end;
+            dim->values[dim->count++] = strtod(p, &end);
+            if(end == p)
+                return 0;
+            p = (*end == ',') ? (end + 1) : end;
+        }
+        return (dim->count > 0);
+    }
+    return 0;
+}
+
+/// Point i of the grid - the last dimension changes fastest
+capacity_params_t gridPoint(uint32_t i)
+{
+    double v[DIMENSIONS];
+    for(int d=(DIMENSIONS - 1); d>=0; d--)
+    {
+        v[d] = _sweep.dims[d].values[(i % _sweep.dims[d].count)];
+        i /= _sweep.dims[d].count;
+    }
+    capacity_params_t p =
+    {
+        .nodes = (uint32_t)v[0], .payload = (uint32_t)v[1], .bitrate = v[2], .ber = v[3], .load = v[4],
+        .queue = (uint32_t)v[5], .cut = (uint8_t)v[6], .broadcast = v[7], .hours = v[8], .seed = (uint64_t)v[9]
+    };
+    return p;
+}
+
+void runPoint(const uint32_t task, const uint32_t worker, void* context)
+{
+    _sweep.results[task] = capacityRun(&_sweep.params[task], &_sweep.arenas[worker]);
+}
+
+void writeCsv(FILE* out)
+{
+    fprintf(out, "nodes,payload,bitrate,ber,load,queue,cut,broadcast,hours,seed,"
+                 "goodput,p50,p90,p99,p999,delivered,broadcasts,crc,dropped,refused,util,utilmax\n");
+    for(uint32_t i=0; i<_sweep.points; i++)
+    {
+        capacity_params_t* p = &_sweep.params[i];
+        capacity_result_t* r = &_sweep.results[i];
+        fprintf(out, "%u,%u,%g,%g,%g,%u,%u,%g,%g,%llu,%.3f,%.3f,%.3f,%.3f,%.3f,%llu,%llu,%llu,%llu,%llu,%.4f,%.4f\n",
+                p->nodes, p->payload, p->bitrate, p->ber, p->load, p->queue, p->cut, p->broadcast, p->hours,
+                (unsigned long long)p->seed, r->goodput, r->p50, r->p90, r->p99, r->p999,
+                (unsigned long long)r->delivered, (unsigned long long)r->broadcasts, (unsigned long long)r->crcFailed,
+                (unsigned long long)r->dropped, (unsigned long long)r->refused, r->utilAvg, r->utilMax);
+    }
+}
+
+void writeJson(FILE* out)
+{
+    fprintf(out, "[\n");
+    for(uint32_t i=0; i<_sweep.points; i++)
+    {
+        capacity_params_t* p = &_sweep.params[i];
+        capacity_result_t* r = &_sweep.results[i];
+        fprintf(out, "  {\"nodes\": %u, \"payload\": %u, \"bitrate\": %g, \"ber\": %g, \"load\": %g, \"queue\": %u, "
+                     "\"cut\": %u, \"broadcast\": %g, \"hours\": %g, \"seed\": %llu, "
+                     "\"goodput\": %.3f, \"p50\": %.3f, \"p90\": %.3f, \"p99\": %.3f, \"p999\": %.3f, "
+                     "\"delivered\": %llu, \"broadcasts\": %llu, \"crc\": %llu, \"dropped\": %llu, \"refused\": %llu, "
+                     "\"util\": %.4f, \"utilmax\": %.4f}%s\n",
+                p->nodes, p->payload, p->bitrate, p->ber, p->load, p->queue, p->cut, p->broadcast, p->hours,
+                (unsigned long long)p->seed, r->goodput, r->p50, r->p90, r->p99, r->p999,
+                (unsigned long long)r->delivered, (unsigned long long)r->broadcasts, (unsigned long long)r->crcFailed,
+                (unsigned long long)r->dropped, (unsigned long long)r->refused, r->utilAvg, r->utilMax,
+                (i + 1 < _sweep.points) ? "," : "");
+    }
+    fprintf(out, "]\n");
+}
+
+int main(int argc, char** argv)
+{
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    uint32_t threads = (cores > 0) ? (uint32_t)cores : 1;
+    const char* format = "csv";
+    const char* path = 0;
+
+    for(int i=1; i<argc; i++)
+    {
+        if(!strcmp(argv[i], "-j") && ((i + 1) < argc))
+            threads = atoi(argv[++i]);
+        else if(!strcmp(argv[i], "-f") && ((i + 1) < argc))
+            format = argv[++i];
+        else if(!strcmp(argv[i], "-o") && ((i + 1) < argc))
+            path = argv[++i];
+        else if(!parseDimension(argv[i]))
+        {
+            fprintf(stderr, "unknown argument %s\n", argv[i]);
+            return 1;
+        }
+    }
+    if((threads < 1) || (threads > POOL_MAX_WORKERS) || (strcmp(format, "csv") && strcmp(format, "json")))
+    {
+        fprintf(stderr, "threads 1 to %u, format csv or json\n", POOL_MAX_WORKERS);
+        return 1;
+    }
+
+    _sweep.points = 1;
+    for(uint32_t d=0; d<DIMENSIONS; d++)
+        _sweep.points *= _sweep.dims[d].count;
+    _sweep.params = malloc(sizeof(capacity_params_t) * _sweep.points);
+    _sweep.results = calloc(_sweep.points, sizeof(capacity_result_t));
+    for(uint32_t i=0; i<_sweep.points; i++)
+    {
+        _sweep.params[i] = gridPoint(i);
+        capacity_params_t* p = &_sweep.params[i];
+        if((p->nodes < 2) || (p->nodes > CAPACITY_MAX_NODES) || (p->queue < 1) || (p->queue > CAPACITY_MAX_QUEUE) ||
+           (p->payload > (LEGACY_PAYLOAD - HDR_SIZE)) || (p->bitrate <= 0.0) || (p->load <= 0.0))
+        {
+            fprintf(stderr, "point %u: nodes 2 to %u, queue 1 to %u, payload up to %u, bitrate and load above 0\n",
+                    i, CAPACITY_MAX_NODES, CAPACITY_MAX_QUEUE, LEGACY_PAYLOAD - HDR_SIZE);
+            return 1;
+        }
+    }
+
+    _sweep.arenas = malloc(sizeof(arena_t) * threads);
+    for(uint32_t w=0; w<threads; w++)
+        arenaInit(&_sweep.arenas[w], CAPACITY_ARENA_SIZE);
+
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    uint64_t stolen = poolRun(_sweep.points, threads, runPoint, 0);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    double seconds = (t1.tv_sec - t0.tv_sec) + ((t1.tv_nsec - t0.tv_nsec) / 1e9);
+    fprintf(stderr, "%u scenarios on %u threads in %.2f s, %llu stolen\n",
+            _sweep.points, threads, seconds, (unsigned long long)stolen);
+
+    FILE* out = path ? fopen(path, "w") : stdout;
+    if(!out)
+    {
+        fprintf(stderr, "cannot write %s\n", path);
+        return 1;
+    }
+    if(!strcmp(format, "json"))
+        writeJson(out);
+    else
+        writeCsv(out);
+    if(path)
+        fclose(out);
+
+    for(uint32_t w=0; w<threads; w++)
+        arenaFree(&_sweep.arenas[w]);
+    free(_sweep.arenas);
+    free(_sweep.results);
+    free(_sweep.params);
+    return 0;
+}
@@ -0,0 +1,213 @@
+/*!
+  * \brief      Host simulation of the token MAC of USE_TOKEN against uncoordinated access
+  * \details    Every node gets frames of its own at random to random destinations. Relayed frames go first
+  *             at every node, frames are relayed store-and-forward like the firmware does.
+  *             Without the token a node starts its own frame whenever its transmitter is idle.
+  *             With the token only the holder does, for at most TOKEN_HOLD_BITS, and then passes it on.
+  *             Throughput counts the payload bits delivered per bit time of one link.
+  *             Access latency runs from the moment a frame is first in line at its node to its first bit on the wire,
+  *             so it leaves out the wait behind earlier frames of the same node.
+  *             Usage: ./token_sim [ring size] [holding bits] */
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "link.c"
+#include "event.c"
+
+#define PREAMBLE_BITS   8
+#define HEADER_BITS     40
+#define TOKEN_BITS      (PREAMBLE_BITS + HEADER_BITS + 16)
+#define MAX_FRAME_BITS  2056
+#define MAX_NODES       32
+#define BACKLOG         1024
+#define DURATION        2000000
+
+#define EVENT_DONE      1
+#define EVENT_ARRIVAL   2
+
+typedef struct
+{
+    uint8_t dst;
+    uint8_t token;
+    uint16_t bytes;
+} sim_frame_t;
+
+typedef struct
+{
+    sim_frame_t relay[BACKLOG];
+    uint32_t relayHead, relayCount;
+    uint64_t own[BACKLOG];
+    uint16_t ownBytes[BACKLOG];
+    uint32_t ownHead, ownCount;
+    uint64_t headSince;
+    sim_frame_t wire;
+    uint8_t busy, held;
+    uint64_t since;
+} node_t;
+
+typedef struct
+{
+    uint64_t payloadBits, frames, accessSum, accessMax, lost;
+} result_t;
+
+static node_t _nodes[MAX_NODES];
+static uint32_t _ring, _hold;
+static result_t _r;
+
+uint64_t wireBits(const sim_frame_t* f)
+{
+    return f->token ? TOKEN_BITS : (PREAMBLE_BITS + HEADER_BITS + (f->bytes * 8));
+}
+
+void transmit(const uint32_t n, const sim_frame_t f, const uint64_t now)
+{
+    _nodes[n].wire = f;
+    _nodes[n].busy = 1;
+    event_t e = { .time = now + wireBits(&f), .type = EVENT_DONE, .node = (uint8_t)n };
+    eventPush(e);
+}
+
+/// Starts the next frame of an idle node
+void start(const uint32_t n, const uint64_t now, const uint8_t token)
+{
+    node_t* node = &_nodes[n];
+    if(node->busy)
+        return;
+
+    if(node->relayCount)
+    {
+        sim_frame_t f = node->relay[node->relayHead];
+        node->relayHead = (node->relayHead + 1) % BACKLOG;
+        node->relayCount--;
+        transmit(n, f, now);
+        return;
+    }
+
+    uint8_t may = token ? (node->held && ((now - node->since) < _hold)) : 1;
+    if(node->ownCount && may)
+    {
+        uint64_t access = now - node->headSince;
+        sim_frame_t f = { .dst = 0, .token = 0, .bytes = node->ownBytes[node->ownHead] };
+        f.dst = (n + 1 + (linkRandom() % (_ring - 1))) % _ring;
+        node->ownHead = (node->ownHead + 1) % BACKLOG;
+        node->ownCount--;
+        node->headSince = now;
+        _r.accessSum += access;
+        if(access > _r.accessMax)
+            _r.accessMax = access;
+        transmit(n, f, now);
+        return;
+    }
+
+    if(token && node->held)
+    {
+        sim_frame_t f = { .dst = (uint8_t)((n + 1) % _ring), .token = 1, .bytes = 0 };
+        node->held = 0;
+        transmit(n, f, now);
+    }
+}
+
+void arrival(const uint32_t n, const uint64_t now, const double rate)
+{
+    node_t* node = &_nodes[n];
+    if(node->ownCount >= BACKLOG)
+        _r.lost++;
+    else
+    {
+        uint32_t tail = (node->ownHead + node->ownCount) % BACKLOG;
+        node->own[tail] = now;
+        node->ownBytes[tail] = 8 + (linkRandom() % 120);
+        if(node->ownCount++ == 0)
+            node->headSince = now;
+    }
+    double u = ((double)linkRandom() + 1.0) / 4294967297.0;
+    event_t e = { .time = now + 1 + (uint64_t)(-log(u) / rate), .type = EVENT_ARRIVAL, .node = (uint8_t)n };
+    eventPush(e);
+}
+
+/// "load" is the offered payload of all nodes together in bits per bit time
+result_t run(const double load, const uint8_t token)
+{
+    // 68 payload bytes on average
+    const double rate = load / (_ring * 68.0 * 8.0);
+    _r = (result_t){ 0, 0, 0, 0, 0 };
+    eventClear();
+    for(uint32_t n=0; n<_ring; n++)
+    {
+        _nodes[n] = (node_t){ .busy = 0 };
+        arrival(n, 0, rate);
+    }
+    _nodes[0].held = token;
+
+    for(uint32_t n=0; n<_ring; n++)
+        start(n, 0, token);
+
+    while(eventCount() && (eventNext() < DURATION))
+    {
+        event_t e = eventPop();
+        if(e.type == EVENT_ARRIVAL)
+        {
+            arrival(e.node, e.time, rate);
+            start(e.node, e.time, token);
+            continue;
+        }
+
+        node_t* node = &_nodes[e.node];
+        uint32_t next = (e.node + 1) % _ring;
+        sim_frame_t f = node->wire;
+        node->busy = 0;
+
+        if(f.token)
+        {
+            _nodes[next].held = 1;
+            _nodes[next].since = e.time;
+        }
+        else if(f.dst == next)
+        {
+            _r.payloadBits += f.bytes * 8;
+            _r.frames++;
+        }
+        else
+        {
+            node_t* down = &_nodes[next];
+            down->relay[((down->relayHead + down->relayCount) % BACKLOG)] = f;
+            down->relayCount++;
+        }
+        start(next, e.time, token);
+        start(e.node, e.time, token);
+    }
+    return _r;
+}
+
+int main(int argc, char** argv)
+{
+    _ring = (argc > 1) ? atoi(argv[1]) : 8;
+    _hold = (argc > 2) ? atoi(argv[2]) : MAX_FRAME_BITS;
+    const double loads[7] = { 0.1, 0.25, 0.5, 0.75, 1.0, 1.5, 2.0 };
+
+    if((_ring < 2) || (_ring > MAX_NODES))
+    {
+        fprintf(stderr, "ring size 2 to %u\n", MAX_NODES);
+        return 1;
+    }
+
+    // Same rule as TOKEN_ROTATION_BITS
+    uint64_t bound = (_ring * (_hold + MAX_FRAME_BITS + TOKEN_BITS)) + ((_ring - 1) * MAX_FRAME_BITS);
+    linkSeed(1);
+    printf("ring of %u nodes, holding time %u bits, access bound %llu bits\n\n", _ring, _hold, (unsigned long long)bound);
+    printf("%-8s%24s%24s\n", "", "UNCOORDINATED", "TOKEN");
+    printf("%-8s%8s%8s%8s%8s%8s%8s\n", "OFFERED", "THRU", "AVG", "MAX", "THRU", "AVG", "MAX");
+
+    for(int l=0; l<7; l++)
+    {
+        printf("%-8.2f", loads[l]);
+        for(uint8_t token=0; token<2; token++)
+        {
+            result_t r = run(loads[l], token);
+            printf("%8.3f%8.0f%8llu", (double)r.payloadBits / DURATION,
+                   r.frames ? (double)r.accessSum / r.frames : 0.0, (unsigned long long)r.accessMax);
+        }
+        printf("\n");
+    }
+    return 0;
+}
@@ -0,0 +1,189 @@
+/*!
+  * \brief      Host benchmark of the layer 4 sliding window of USE_L4
+  * \details    Node 0 streams messages to the node "distance" hops downstream, which answers every segment
+  *             with a cumulative and selective ACK that travels on around the ring.
+  *             Frames are stored and forwarded on every hop. Sender and receiver follow transport.c.
+  *             Reports messages per second at LINK_BITRATE for several window sizes and ring lengths.
+  *             Usage: ./transport_bench [message size] [messages] [ber] */
+#include <stdio.h>
+#include <stdlib.h>
+#include "link.c"
+#include "event.c"
+
+#define PREAMBLE_BITS   8
+#define HEADER_BITS     40
+/// Addresses and the layer 4 header
+#define L4_HEADER       5
+#define RETRIES         5
+#define WINDOW_MAX      8
+
+#define EVENT_SEGMENT   1
+#define EVENT_ACK       2
+
+typedef struct
+{
+    uint8_t tries;
+    uint64_t sent;
+} slot_t;
+
+/// Sends a frame of "bits" over "hops" links, returns 1 if no bit was flipped
+uint8_t survives(const uint32_t bits, const uint32_t hops, const double ber)
+{
+    for(uint32_t h=0; h<hops; h++)
+    {
+        for(uint32_t i=0; i<bits; i++)
+            if(linkError(ber)) return 0x00;
+    }
+    return 0x01;
+}
+
+double simulate(const uint32_t ring, const uint32_t distance, const uint32_t window,
+                const uint32_t size, const uint32_t messages, const double ber)
+{
+    const uint32_t segmentBits = PREAMBLE_BITS + HEADER_BITS + ((L4_HEADER + size) * 8);
+    const uint32_t ackBits = PREAMBLE_BITS + HEADER_BITS + ((L4_HEADER + 1) * 8);
+    const uint64_t timeout = (uint64_t)ring * 2040 * 2;
+
+    slot_t slots[WINDOW_MAX] = { { 0, 0 } };
+    uint8_t txBase = 0, txNext = 0;
+    uint8_t rxNext = 0, rxMask = 0;
+    uint64_t now = 0, ackFree = 0;
+    uint32_t sent = 0, delivered = 0;
+
+    eventClear();
+    while((sent < messages) || (txBase != txNext))
+    {
+        while(eventNext() <= now)
+        {
+            event_t e = eventPop();
+            if(e.type == EVENT_SEGMENT)
+            {
+                if(!e.ok)
+                    continue;
+
+                uint8_t offset = (uint8_t)(e.seq - rxNext);
+                if(offset == 0)
+                {
+                    uint8_t have = 1;
+                    while(have)
+                    {
+                        have = (rxMask & 0x01);
+                        rxMask >>= 1;
+                        rxNext++;
+                    }
+                    delivered++;
+                }
+                else if(offset <= 8)
+                {
+                    if(!(rxMask & (1 << (offset-1))))
+                        delivered++;
+                    rxMask |= (1 << (offset-1));
+                }
+                else if(offset < 128)
+                    continue;
+
+                // The ACK leaves as soon as the receiver's transmitter is free
+                uint64_t depart = (e.time > ackFree) ? e.time : ackFree;
+                ackFree = depart + ackBits;
+                event_t ack = { depart + ((uint64_t)(ring - distance) * ackBits), EVENT_ACK, 0,
+                                (uint8_t)(rxNext - 1), survives(ackBits, ring - distance, ber), rxMask };
+                eventPush(ack);
+            }
+            else if(e.ok)
+            {
+                while((uint8_t)(e.seq - txBase) < (uint8_t)(txNext - txBase))
+                {
+                    slots[(txBase % window)].tries = 0;
+                    txBase++;
+                }
+                for(uint8_t i=0; i<8; i++)
+                {
+                    uint8_t id = (e.seq + 2 + i);
+                    if((e.arg & (1 << i)) && ((uint8_t)(id - txBase) < (uint8_t)(txNext - txBase)))
+                        slots[(id % window)].tries = 0;
+                }
+                while((txBase != txNext) && (slots[(txBase % window)].tries == 0))
+                    txBase++;
+            }
+        }
+
+        // Oldest expired segment first, then a new one if the window is open
+        int32_t pick = -1;
+        uint64_t wake = UINT64_MAX;
+        for(uint8_t id=txBase; id!=txNext; id++)
+        {
+            slot_t* s = &slots[(id % window)];
+            if(s->tries == 0)
+                continue;
+            if((now - s->sent) > timeout)
+            {
+                if(s->tries >= RETRIES)
+                {
+                    s->tries = 0;
+                    continue;
+                }
+                pick = id;
+                break;
+            }
+            if((s->sent + timeout + 1) < wake)
+                wake = s->sent + timeout + 1;
+        }
+        while((txBase != txNext) && (slots[(txBase % window)].tries == 0))
+            txBase++;
+
+        if((pick < 0) && ((uint8_t)(txNext - txBase) < window) && (sent < messages))
+        {
+            pick = txNext++;
+            slots[(pick % window)].tries = 0;
+            sent++;
+        }
+
+        if(pick < 0)
+        {
+            if(eventNext() < wake)
+                wake = eventNext();
+            if(wake == UINT64_MAX)
+                break;
+            now = (wake > now) ? wake : (now + 1);
+            continue;
+        }
+
+        slot_t* s = &slots[(pick % window)];
+        s->tries++;
+        s->sent = now;
+        event_t segment = { now + ((uint64_t)distance * segmentBits), EVENT_SEGMENT, 0,
+                            (uint8_t)pick, survives(segmentBits, distance, ber), 0 };
+        eventPush(segment);
+        now += segmentBits;
+    }
+
+    while(eventCount() > 0)
+        now = eventPop().time;
+    return (delivered * LINK_BITRATE) / (double)now;
+}
+
+int main(int argc, char** argv)
+{
+    const uint32_t size = (argc > 1) ? (uint32_t)atoi(argv[1]) : 32;
+    const uint32_t messages = (argc > 2) ? (uint32_t)atoi(argv[2]) : 2000;
+    const double ber = (argc > 3) ? atof(argv[3]) : 0.0;
+    const uint32_t rings[5] = { 2, 4, 8, 16, 32 };
+    const uint32_t windows[4] = { 1, 2, 4, 8 };
+
+    linkSeed(1);
+    printf("%u-byte messages to the node half way round, BER %g, %.1f bit/s - messages per second\n\n",
+        size, ber, LINK_BITRATE);
+    printf("%-6s", "RING");
+    for(int w=0; w<4; w++)
+        printf("       W=%u", windows[w]);
+    printf("\n");
+
+    for(int r=0; r<5; r++)
+    {
+        printf("%-6u", rings[r]);
+        for(int w=0; w<4; w++)
+            printf("%10.3f", simulate(rings[r], (rings[r] / 2), windows[w], size, messages, ber));
+        printf("\n");
+    }
+    return 0;
+}
@@ -0,0 +1,104 @@
+#pragma once
+#include "interrupt.h"
+#include "aggregate.h"
+#include "calc.c"
+#include "layer3.c"
+#include "stats.c"
+#include "arq.c"
+
+#if USE_AGG
+void aggPrintMessage(const uint8_t src, const uint8_t* data, const uint8_t length)
+{
+    printMsg("RECORD FROM ", 12);
+    printNumber(src);
+    printMsg(" : ", 3);
+    printMsg((const char*)data, length);
+    uart_changeLine();
+}
+
+/// Appends a record to the frame being filled, returns 0 if it does not fit
+uint8_t aggAppend(const uint8_t dst, const uint8_t src, const uint8_t* data, const uint8_t length)
+{
+    uint16_t used = FRAME_LENGTH(&aggFrame);
+    if(used == 0)
+    {
+        clearFrame(&aggFrame);
+        aggFrame.payload[HDR_DST] = AGGREGATE_ID;
+        aggFrame.payload[HDR_SRC] = MY_ID;
+        used = HDR_SIZE;
+        aggFirst = ticks;
+    }
+
+    if(((used + AGG_HEADER + length) > LEGACY_PAYLOAD) || (aggRecords >= AGG_MAX_RECORDS))
+        return 0x00;
+
+    aggFrame.payload[(used+AGG_DST)] = dst;
+    aggFrame.payload[(used+AGG_SRC)] = src;
+    aggFrame.payload[(used+AGG_LENGTH)] = length;
+    for(uint8_t i=0; i<length; i++)
+        aggFrame.payload[(used+AGG_HEADER+i)] = data[i];
+    SET_LENGTH(&aggFrame, (used + AGG_HEADER + length));
+    aggRecords++;
+    return 0x01;
+}
+
+uint8_t aggSend(const uint8_t dst, const uint8_t* data, const uint8_t length)
+{
+    if(length > AGG_MAX_MESSAGE)
+        return 0x00;
+
+    for(;;)
+    {
+        HAL_IRQ_OFF();
+        uint8_t queued = aggAppend(dst, MY_ID, data, length);
+        HAL_IRQ_ON();
+        if(queued)
+            return 0x01;
+    }
+}
+
+void aggReceive(const frame_t* frame)
+{
+    uint16_t pos = HDR_SIZE;
+
+    while((pos + AGG_HEADER) <= FRAME_LENGTH(frame))
+    {
+        uint8_t dst = frame->payload[(pos+AGG_DST)];
+        uint8_t src = frame->payload[(pos+AGG_SRC)];
+        uint8_t length = frame->payload[(pos+AGG_LENGTH)];
+        const uint8_t* data = &frame->payload[(pos+AGG_HEADER)];
+
+        if((pos + AGG_HEADER + length) > FRAME_LENGTH(frame))
+            break;
+        pos += (AGG_HEADER + length);
+        stats.aggRecords++;
+
+        // Same cases as checkAddress - returned records end here, others go on to the next node
+        if(src == MY_ID)
+            continue;
+        if((dst == MY_ID) || (dst == BROADCAST_ID))
+            aggOnMessage(src, data, length);
+        if((dst != MY_ID) && !aggAppend(dst, src, data, length))
+            stats.aggDropped++;
+    }
+}
+
+uint8_t aggPoll(frame_t* frame)
+{
+    if(aggRecords == 0)
+        return 0x00;
+    if((aggRecords < AGG_MAX_RECORDS) && ((ticks - aggFirst) <= (AGG_FLUSH_BITS*BIT_TICKS)))
+        return 0x00;
+
+    *frame = aggFrame;
+    makeCrc(frame->crc, frame->payload, FRAME_LENGTH(frame), _polynomial, GENERATE);
+#if USE_ARQ
+    if(!arqStamp(frame))
+        return 0x00;
+#endif
+    stats.aggFrames++;
+    SET_LENGTH(&aggFrame, 0);
+    aggRecords = 0;
+    return 0x01;
+}
+#endif
@@ -0,0 +1,55 @@
+#pragma once
+#include "config.h"
+
+/// Record of an aggregated frame - destination, source, data size, then the data
+#define AGG_DST             0
+#define AGG_SRC             1
+#define AGG_LENGTH          2
+#define AGG_HEADER          3
+
+/// Records per frame after which the frame goes out without waiting for the flush timer
+#define AGG_MAX_RECORDS     8
+
+/// Bit times the first queued record waits for company before its frame goes out anyway
+#define AGG_FLUSH_BITS      64
+
+/// Largest message worth aggregating - longer ones are sent in their own frame
+#define AGG_MAX_MESSAGE     32
+
+#if USE_AGG
+/// Frame being filled with records, the tick of its first record and its record count
+frame_t aggFrame;
+uint32_t aggFirst = 0;
+uint8_t aggRecords = 0;
+#endif
+
+/*! \brief      Application callback for every record addressed to this node or to everybody
+  * \details    Runs inside the receive interrupt, "data" points into the receive buffer */
+void (*aggOnMessage)(const uint8_t src, const uint8_t* data, const uint8_t length);
+
+
+/*! \brief      Default aggOnMessage - prints the sender and the message on Minicom
+  * \return     void */
+void aggPrintMessage(const uint8_t src, const uint8_t* data, const uint8_t length);
+
+
+/*! \brief      Queues a small message for the next aggregated frame
+  * \details    Waits while the frame is full - must not be called from an interrupt routine
+  * \param      dst     - Destination node or BROADCAST_ID
+  * \param      data    - Message
+  * \param      length  - Size of the message, at most AGG_MAX_MESSAGE
+  * \return     unsigned 8-bits data - 1 if queued, 0 if the message is too long */
+uint8_t aggSend(const uint8_t dst, const uint8_t* data, const uint8_t length);
+
+
+/*! \brief      Splits a received aggregated frame
+  * \details    Records for this node are handed to aggOnMessage in place, records for others are queued again
+  * \param      frame   - Received frame with AGGREGATE_ID as destination
+  * \return     void */
+void aggReceive(const frame_t* frame);
+
+
+/*! \brief      Moves the aggregated frame into the idle transmitter when it is full or its flush timer ran out
+  * \param      frame   - Transmit buffer
+  * \return     unsigned 8-bits data - 1 if the frame has been filled, else 0 */
+uint8_t aggPoll(frame_t* frame);
@@ -0,0 +1,207 @@
+#pragma once
+#include "arq.h"
+#include "calc.c"
+#include "layer3.c"
+#include "stats.c"
+
+#if USE_ARQ
+/// Number of frames sent but not acknowledged yet
+#define ARQ_OUTSTANDING()   ((arqNext - arqBase) & LINK_SEQ_MASK)
+
+uint8_t arqWindowOpen()
+{
+    return (ARQ_OUTSTANDING() < ARQ_WINDOW) ? 0x01 : 0x00;
+}
+
+uint8_t arqStamp(frame_t* frame)
+{
+    if(frame->payload[HDR_LINK] & LINK_CONTROL)
+        return 0x01;
+    if(!arqWindowOpen())
+        return 0x00;
+
+    frame->payload[HDR_LINK] = arqNext;
+    clearBuffer(frame->crc, 32);
+    makeCrc(frame->crc, frame->payload, FRAME_LENGTH(frame), _polynomial, GENERATE);
+
+    if(arqBase == arqNext)
+    {
+        arqTries = 0;
+        arqTimer = ticks;
+    }
+    arqFrames[(arqNext % ARQ_WINDOW)] = *frame;
+    arqNext = ((arqNext + 1) & LINK_SEQ_MASK);
+    return 0x01;
+}
+
+/// Releases every frame before "seq", which the downstream neighbour expects next
+void arqAcknowledge(const uint8_t seq)
+{
+    if(((seq - arqBase) & LINK_SEQ_MASK) > ARQ_OUTSTANDING())
+        return;
+
+    if(seq != arqBase)
+    {
+        arqBase = seq;
+        arqTries = 0;
+        arqTimer = ticks;
+    }
+    if(((arqResend - arqBase) & LINK_SEQ_MASK) > ARQ_OUTSTANDING())
+        arqResend = arqBase;
+    if(arqBase == arqNext)
+        arqResending = 0;
+}
+
+/// Drops the oldest frame after ARQ_RETRIES and has the downstream neighbour skip it
+void arqGiveUp()
+{
+    stats.arqGiveUps++;
+    arqAcknowledge((arqBase + 1) & LINK_SEQ_MASK);
+    arqSync = 1;
+}
+
+/// Queues a control message for the upstream neighbour
+void arqAnswer(const uint8_t type)
+{
+    arqReply = type;
+    arqReplySeq = arqExpect;
+}
+
+uint8_t arqFilter(const frame_t* frame)
+{
+    uint8_t link = frame->payload[HDR_LINK];
+
+    // Control frames are never acknowledged themselves
+    if(link & LINK_CONTROL)
+    {
+        if(frame->payload[HDR_SRC] == MY_ID)
+            return 0x00;
+        if(frame->payload[HDR_DST] != MY_ID)
+            return 0x01;
+
+        uint8_t seq = frame->payload[HDR_SIZE+1];
+        if(frame->payload[HDR_SIZE] == ARQ_SYNC)
+        {
+            // The upstream neighbour gave up the frames before seq, a stale sync is behind and ignored
+            if(((seq - arqExpect) & LINK_SEQ_MASK) < (LINK_SEQ_MASK / 2))
+                arqExpect = seq;
+            arqAnswer(ARQ_NACK);
+            return 0x00;
+        }
+
+        arqAcknowledge(seq);
+        if(frame->payload[HDR_SIZE] == ARQ_NACK)
+        {
+            stats.arqNacks++;
+
+            // The downstream neighbour still waits for a frame that was given up - its sync got lost
+            if(((seq - arqBase) & LINK_SEQ_MASK) > ARQ_OUTSTANDING())
+            {
+                arqSync = 1;
+                return 0x00;
+            }
+            if(arqBase != arqNext)
+            {
+                if((++arqTries) > ARQ_RETRIES)
+                {
+                    arqGiveUp();
+                    if(arqBase == arqNext)
+                        return 0x00;
+                }
+                arqResend = arqBase;
+                arqResending = 1;
+            }
+        }
+        return 0x00;
+    }
+
+    uint8_t seq = (link & LINK_SEQ_MASK);
+    uint8_t behind = ((arqExpect - seq) & LINK_SEQ_MASK);
+    uint8_t ahead = ((seq - arqExpect) & LINK_SEQ_MASK);
+
+    // Duplicate - the upstream neighbour missed an ACK
+    if((behind > 0) && (behind <= ARQ_WINDOW))
+    {
+        stats.arqDuplicates++;
+        arqAnswer(ARQ_ACK);
+        return 0x00;
+    }
+
+    // Gap - a frame before this one was lost
+    if((ahead > 0) && (ahead < ARQ_WINDOW))
+    {
+        arqAnswer(ARQ_NACK);
+        return 0x00;
+    }
+
+    // In order, or far outside the window after the upstream neighbour restarted
+    arqExpect = ((seq + 1) & LINK_SEQ_MASK);
+    arqAnswer(ARQ_ACK);
+    return 0x01;
+}
+
+void arqCorrupted()
+{
+    arqAnswer(ARQ_NACK);
+}
+
+/// Fills the transmit buffer with a control frame
+void arqControl(frame_t* frame, const uint8_t dst, const uint8_t type, const uint8_t seq)
+{
+    clearFrame(frame);
+    SET_LENGTH(frame, (HDR_SIZE + 2));
+    frame->payload[HDR_DST] = dst;
+    frame->payload[HDR_SRC] = MY_ID;
+    frame->payload[HDR_LINK] = LINK_CONTROL;
+#if USE_TTL
+    frame->payload[HDR_TTL] = ttlStart;
+#endif
+    frame->payload[HDR_SIZE] = type;
+    frame->payload[HDR_SIZE+1] = seq;
+    makeCrc(frame->crc, frame->payload, FRAME_LENGTH(frame), _polynomial, GENERATE);
+}
+
+uint8_t arqPoll(frame_t* frame)
+{
+    if(arqReply)
+    {
+        arqControl(frame, PREV_ID, arqReply, arqReplySeq);
+        arqReply = 0;
+        return 0x01;
+    }
+    if(arqSync)
+    {
+        arqControl(frame, NEXT_ID, ARQ_SYNC, arqBase);
+        arqSync = 0;
+        return 0x01;
+    }
+
+    if(arqBase == arqNext)
+        return 0x00;
+
+    // Retransmission Timer - goes back to the oldest frame, or gives it up after ARQ_RETRIES
+    if((!arqResending) && ((ticks - arqTimer) > (ARQ_TIMEOUT_BITS*BIT_TICKS)))
+    {
+        arqTimer = ticks;
+        if((++arqTries) > ARQ_RETRIES)
+        {
+            arqGiveUp();
+            return 0x00;
+        }
+        stats.arqTimeouts++;
+        arqResend = arqBase;
+        arqResending = 1;
+    }
+
+    if(!arqResending)
+        return 0x00;
+
+    *frame = arqFrames[(arqResend % ARQ_WINDOW)];
+    arqResend = ((arqResend + 1) & LINK_SEQ_MASK);
+    if(arqResend == arqNext)
+        arqResending = 0;
+    arqTimer = ticks;
+    stats.arqRetransmits++;
+    return 0x01;
+}
+#endif
@@ -0,0 +1,78 @@
+#pragma once
+#include "config.h"
+
+/// Link byte of the header - bit 7 marks unsequenced control frames, bits 0 to 6 carry the hop sequence number
+#define LINK_CONTROL        0x80
+#define LINK_SEQ_MASK       0x7f
+
+/// Control messages - first data byte of a control frame, followed by a sequence number
+#define ARQ_ACK             1
+#define ARQ_NACK            2
+#define ARQ_SYNC            3
+
+/// Frames kept for retransmission - every slot costs one frame_t of RAM.
+/// The answers go to PREV_ID the long way round, so on a loaded ring every link carries the answers of N-1 nodes
+/// next to its data and the window stays full for a round trip that grows with the ring. A relay that finds it
+/// full is dropped (stats.arqDropped). host/arq_sim measures both for 4 to 64 nodes.
+#define ARQ_WINDOW          2
+
+/// Bit times without an acknowledgement before the window is sent again.
+/// The ACK waits behind the relay of the frame and then travels around the whole ring,
+/// so this covers two of the longest frames (2040 bits) plus one control frame (88 bits) per node.
+/// An ACK that waits behind other frames at every hop can take longer on a loaded ring of many nodes.
+#define ARQ_TIMEOUT_BITS    ((2*2040) + (RING_SIZE*88))
+
+/// Retransmissions of the same frame before it is given up, after a timeout or a NACK alike
+#define ARQ_RETRIES         4
+
+#if USE_ARQ
+/// Sender - copies of the unacknowledged frames and the sequence numbers around them
+frame_t arqFrames[ARQ_WINDOW];
+uint8_t arqBase = 0;
+uint8_t arqNext = 0;
+uint8_t arqResend = 0;
+uint8_t arqResending = 0;
+uint8_t arqTries = 0;
+uint32_t arqTimer = 0;
+uint8_t arqSync = 0;
+
+/// Receiver - next expected sequence number and the control message waiting for the transmitter
+uint8_t arqExpect = 0;
+uint8_t arqReply = 0;
+uint8_t arqReplySeq = 0;
+#endif
+
+/*! \brief      Checks whether another frame fits into the retransmission window
+  * \return     unsigned 8-bits data - 1(true) or 0(false) */
+uint8_t arqWindowOpen();
+
+
+/*! \brief      Stamps the next hop sequence number on a data frame, regenerates its crc and keeps a copy
+  * \details    Control frames pass unchanged
+  * \param      frame   - Frame about to be loaded into the transmitter
+  * \return     unsigned 8-bits data - 1 if the frame may be sent, 0 if the window is full */
+uint8_t arqStamp(frame_t* frame);
+
+
+/*! \brief      Runs the link layer part of a received frame with a valid crc
+  * \details    Consumes acknowledgements addressed to this node and drops duplicate or out-of-order data frames.
+  *             Every accepted data frame is answered with a cumulative ACK to PREV_ID. An ARQ_SYNC of the
+  *             upstream neighbour moves the expected sequence number past the frames it gave up.
+  *             There is one reply slot: an answer not sent yet is replaced by the next one, which carries the
+  *             newer expected sequence number and so acknowledges everything the old one did.
+  * \param      frame   - Received frame
+  * \return     unsigned 8-bits data - 1 if the frame goes on to layer 3, else 0 */
+uint8_t arqFilter(const frame_t* frame);
+
+
+/*! \brief      Answers a frame with a broken crc with a NACK of the next expected sequence number
+  * \return     void */
+void arqCorrupted();
+
+
+/*! \brief      Loads the next control or retransmitted frame into the idle transmitter
+  * \details    Also runs the retransmission timer. After a frame has been given up, an ARQ_SYNC tells NEXT_ID
+  *             the sequence number to expect instead.
+  * \param      frame   - Transmit buffer
+  * \return     unsigned 8-bits data - 1 if the frame has been filled, else 0 */
+uint8_t arqPoll(frame_t* frame);
@@ -0,0 +1,93 @@
+#pragma once
+#include "interrupt.h"
+#include "bridge.h"
+#include "phy2.c"
+#include "layer3.c"
+#include "stats.c"
+
+#if USE_BRIDGE
+void bridgeInit()
+{
+    for(uint8_t i=0; i<32; i++)
+        bridgeTable[i] = 0;
+    bridgeRoute(BRIDGE_RING, 1);
+}
+
+void bridgeRoute(const uint8_t ring, const uint8_t across)
+{
+    if(across)
+        bridgeTable[(ring >> 3)] |= (1 << (ring & 0x07));
+    else
+        bridgeTable[(ring >> 3)] &= ~(1 << (ring & 0x07));
+}
+
+uint8_t bridgeTake(frame_t* frame)
+{
+    uint8_t dst = frame->payload[HDR_DRING];
+    uint8_t src = frame->payload[HDR_SRING];
+
+    if(BRIDGE_ACROSS(src))
+    {
+        // Came from the second port and went once around
+        stats.bridgeReturned++;
+        return 0x01;
+    }
+    if(!BRIDGE_ACROSS(dst))
+        return 0x00;
+
+    if(!hopFrame(frame) || !phy2Send(frame))
+        stats.bridgeDropped++;
+    else
+        stats.bridgeForwarded++;
+    return 0x01;
+}
+
+void bridgeOnFrame(frame_t* frame)
+{
+    uint8_t dst = frame->payload[HDR_DRING];
+    uint8_t src = frame->payload[HDR_SRING];
+
+    if(BRIDGE_ACROSS(dst) && BRIDGE_ACROSS(src))
+    {
+        // Traffic of the other ring
+        if(!hopFrame(frame) || !phy2Send(frame))
+            stats.bridgeDropped++;
+        phy2Release();
+        return;
+    }
+    if(BRIDGE_ACROSS(dst) || !BRIDGE_ACROSS(src))
+    {
+        // Went from this side across and came back
+        stats.bridgeReturned++;
+        phy2Release();
+        return;
+    }
+
+    // For this side - the bridge itself takes its own and ring-wide messages as well
+    if(IS_MY_RING(dst) && ((frame->payload[HDR_DST] == MY_ID) || (frame->payload[HDR_DST] == BROADCAST_ID)))
+    {
+        if(unpackFrame(sFrame, frame))
+            deliverFrame(sFrame);
+        if(frame->payload[HDR_DST] == MY_ID)
+        {
+            phy2Release();
+            return;
+        }
+    }
+
+    // Held in the receive buffer of the second port until the first transmitter is idle
+}
+
+uint8_t bridgePoll(frame_t* frame)
+{
+    if(phy2RxFlag != FLAG_LAYER_3)
+        return 0x00;
+
+    *frame = phy2Rx;
+    phy2Release();
+    if(!hopFrame(frame))
+        return 0x00;
+    stats.bridgeInjected++;
+    return 0x01;
+}
+#endif
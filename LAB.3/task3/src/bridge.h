@@ -0,0 +1,42 @@
+#pragma once
+#include "config.h"
+
+/// Ring on the second port of a bridge
+#define BRIDGE_RING         0x02
+
+#if USE_BRIDGE
+/// Forwarding table - one bit per ring ID, set for the rings reached through the second port
+uint8_t bridgeTable[32];
+#define BRIDGE_ACROSS(ring) (bridgeTable[((ring) >> 3)] & (1 << ((ring) & 0x07)))
+#endif
+
+/*! \brief      Empties the forwarding table and enters BRIDGE_RING behind the second port
+  * \return     void */
+void bridgeInit();
+
+
+/*! \brief      Enters which port leads to a ring
+  * \param      ring    - Ring ID
+  * \param      across  - 1 if the ring lies behind the second port, 0 if behind the first one
+  * \return     void */
+void bridgeRoute(const uint8_t ring, const uint8_t across);
+
+
+/*! \brief      Takes frames off the first ring that belong to the other side of the bridge
+  * \details    Frames for a ring behind the second port are handed to it, frames from there that
+  *             went once around this ring are removed - one table lookup per frame
+  * \param      frame   - Intact frame received on the first port, a forwarded frame uses up one hop
+  * \return     unsigned 8-bits data - 1 if the frame has been taken, 0 if it stays on this ring */
+uint8_t bridgeTake(frame_t* frame);
+
+
+/*! \brief      phy2OnFrame of a bridge - relays, delivers or holds the frame for the first ring
+  * \param      frame   - Intact frame received on the second port
+  * \return     void */
+void bridgeOnFrame(frame_t* frame);
+
+
+/*! \brief      Moves a frame held for the first ring into its idle transmitter
+  * \param      frame   - Transmit buffer
+  * \return     unsigned 8-bits data - 1 if the frame has been filled, else 0 */
+uint8_t bridgePoll(frame_t* frame);
@@ -1,6 +1,8 @@
 #pragma once
 #include "uart.h"
 #include "calc.h"
+#include "fec.c"
+#include "compress.c"
 
 void printMsg(const char* msg, const uint8_t length)
 {
@@ -8,6 +10,56 @@ void printMsg(const char* msg, const uint8_t length)
         uart_transmit(msg[i]);
 }
 
+void printFlash(const char* msg, const uint8_t length)
+{
+    for(int i=0; i<length; i++)
+        uart_transmit(HAL_FLASH_BYTE(msg + i));
+}
+
+void printNumber(uint32_t number)
+{
+    char digits[10];
+    uint8_t length = 0;
+
+    do
+    {
+        digits[length++] = '0' + (number % 10);
+        number /= 10;
+    } while(number > 0);
+
+    while(length > 0)
+        uart_transmit(digits[--length]);
+}
+
+uint8_t readNumber(const char* prompt, const uint8_t length)
+{
+    uint8_t number = 0;
+    uint8_t input = 0;
+    printMsg(prompt, length);
+
+    while(1)
+    {
+        input = uart_receive();
+        uart_transmit((char)input);
+
+        if(input == 0x0d)
+            break;
+
+        /// Initializes the written numbers by pressing 'Backspace'
+        if((input == 0x7f) || (input == 0x08))
+        {
+            number = 0;
+            uart_transmit('\r'); printMsg(prompt, length); printMsg("      ", 6);
+            uart_transmit('\r'); printMsg(prompt, length);
+        }
+        else
+        {
+            number = ((number * 10) + (input - 48));
+        }
+    }
+    return number;
+}
+
 uint8_t readBit(const uint8_t* buffer, const uint32_t pos)
 {
     if((buffer[(pos/8)] & (0b10000000 >> (pos%8))))
@@ -36,6 +88,31 @@ void updateBit(uint8_t* buffer, const uint32_t pos, const uint8_t data)
     buffer[tmp] += data;
 }
 
+uint8_t readCodeBit(const uint8_t* buffer, const uint32_t pos)
+{
+#if USE_FEC
+    return ((hammingEncode(buffer[(pos/CODE_BITS)]) >> (pos%CODE_BITS)) & 0x01);
+#else
+    return readBit(buffer, pos);
+#endif
+}
+
+uint8_t writeCodeBit(uint8_t* buffer, const uint32_t pos, const uint8_t data, uint16_t* code)
+{
+#if USE_FEC
+    if((pos%CODE_BITS) == 0)
+        *code = 0;
+    if(data)
+        *code |= (1 << (pos%CODE_BITS));
+    if((pos%CODE_BITS) == (CODE_BITS-1))
+        return hammingDecode(*code, &buffer[(pos/CODE_BITS)]);
+    return FEC_PENDING;
+#else
+    updateBit(buffer, pos, data);
+    return FEC_OK;
+#endif
+}
+
 void printBit(const uint8_t* buffer, const uint32_t start, const uint32_t end)
 {
     for(int i=start; i<end; i++)
@@ -60,64 +137,41 @@ uint8_t checkPreamble(const uint8_t buffer, const uint8_t preamble)
 
 uint8_t makeCrc(uint8_t* crc, const uint8_t* src, const uint32_t src_size, const uint8_t* polynomial, const uint8_t flag)
 {
-    // This payload will do XOR with polynomial
-    uint32_t payload_size = ((src_size*8) + 32);
-    uint8_t* payload = (uint8_t*) malloc(payload_size);
-
-    // Copies the payload to a temporary variable
-    for(int i=0; i<src_size; i++)
-		payload[i] = src[i];
-    for(int i=src_size; i<(payload_size/8); i++)
-		payload[i] = crc[i-src_size];
+    // The leading 1 of the 33-bits polynomial only clears the bit that leaves the register, the rest is XORed
+    uint32_t low = (((uint32_t)polynomial[0] << 25) | ((uint32_t)polynomial[1] << 17) | ((uint32_t)polynomial[2] << 9)
+                    | ((uint32_t)polynomial[3] << 1) | (polynomial[4] >> 7));
 
     /* CRC Calculation
-	 * When the Payload MSB is equal to 0, then do Left-Shift
-	 * When the Payload MSB is equal to 1, then do XOR */
-    uint32_t iterator = 0;
-    while(iterator < (src_size*8))
+     * Long division of the payload followed by the 32 bits of "crc", one bit at a time through a register
+     * instead of a shifted copy of the whole frame, so it needs neither heap nor stack in the size of the frame.
+     * When the bit leaving the register is 0, the next bit comes in with a Left-Shift only
+     * When the bit leaving the register is 1, the polynomial is XORed in as well */
+    uint32_t remainder = 0;
+    for(uint32_t i=0; i<(src_size + 4); i++)
     {
-        // Payload MSB is 0 : Left-Shift
-        if(!(readBit(payload, 0)))
-        {
-            // Every Element does Left-Shift byte-by-byte
-            for(int i=0; i<(payload_size/8); i++)
-            {
-                if(readBit(&payload[i], 0))
-                {
-                    (!((i-1)<0)) ? (payload[i-1]+=0x01) : (0);
-                }
-                payload[i] &= 0b01111111;
-                payload[i] <<= 1;
-            }
-            iterator++;
-        }
-
-        // Payload MSB is 1 : XOR
-        else
+        uint8_t data = (i < src_size) ? src[i] : crc[i - src_size];
+        for(uint8_t bit=0; bit<8; bit++)
         {
-            for(int i=0; i<33; i++)
-                writeBit(payload, i, (readBit(payload,i)^(readBit(polynomial,i))));
+            uint8_t msb = (remainder >> 31);
+            remainder = ((remainder << 1) | ((data >> (7 - bit)) & 0x01));
+            if(msb)
+                remainder ^= low;
         }
     }
 
-    uint8_t result = 0;
-    for(int i=0; i<4; i++)
+    // Generate Mode
+    if(flag == GENERATE)
     {
-        // Generate Mode
-        if(flag == GENERATE)
-            crc[i] = payload[i];
-
-        // Check Mode
-        else if(flag == CHECK)
-            result += payload[i];
+        for(int i=0; i<4; i++)
+            crc[i] = (remainder >> (24 - (8*i)));
+        return 0x01;
     }
 
-    free(payload);
-
-    if(result == 0)
-	    return 0x01;
+    // Check Mode
+    if(remainder == 0)
+        return 0x01;
     else
-		return 0x00;
+        return 0x00;
 }
 
 void clearBuffer(uint8_t* buffer, const uint32_t bit_size)
@@ -132,9 +186,10 @@ void clearFrame(frame_t* frame)
     for(int i=0; i<4; i++)
 		frame->crc[i] = 0x00;
 	
-    frame->dlc[0] = 0x00;
+    for(int i=0; i<DLC_SIZE; i++)
+		frame->dlc[i] = 0x00;
 	
-    for(int i=0; i<251; i++)
+    for(int i=0; i<FRAME_PAYLOAD; i++)
 		frame->payload[i] = 0x00;
 }
 
@@ -145,7 +200,7 @@ void printFrame(const frame_t* frame)
     uart_changeLine();
 
     printMsg("DLC ", 4);
-    printBit(frame->dlc, 0, 8); 
+    printBit(frame->dlc, 0, (DLC_SIZE*8)); 
     uart_changeLine();
 
     printMsg("DST ", 4);
@@ -157,12 +212,12 @@ void printFrame(const frame_t* frame)
     uart_changeLine();
 
     printMsg("PAY", 3);
-    printBit(frame->payload, 16, ((frame->dlc[0])*8));
+    printBit(frame->payload, 16, (FRAME_LENGTH(frame)*8));
 }
 
 uint8_t receiveData()
 {
-    if((PIND & (1 << PD4)))
+    if(RECEIVED_DATA())
 		return 0x01;
 	else
 		return 0x00;
@@ -9,6 +9,26 @@
 void printMsg(const char* msg, const uint8_t length);
 
 
+/*! \brief      Prints a character string kept in flash with HAL_FLASH_STR on Minicom
+  * \param      msg     - Set of characters to be printed out
+  * \param      length  - Number of characters
+  * \return     void */
+void printFlash(const char* msg, const uint8_t length);
+
+
+/*! \brief      Prints an unsigned number in decimal on Minicom
+  * \param      number  - Number to be printed out
+  * \return     void */
+void printNumber(uint32_t number);
+
+
+/*! \brief      Reads a decimal number typed on Minicom until 'Enter', 'Backspace' starts over
+  * \param      prompt  - Text printed in front of the number
+  * \param      length  - Number of characters of the prompt
+  * \return     unsigned 8-bits data - Typed number */
+uint8_t readNumber(const char* prompt, const uint8_t length);
+
+
 /*! \brief      Reads a specific bit at the specified position on the bits 
   * \param      buffer  - Set of bits to be read
   * \param      pos     - Position of the bit, which counts from left to right
@@ -32,6 +52,24 @@ void writeBit(uint8_t* buffer, const uint32_t pos, const uint8_t data);
 void updateBit(uint8_t* buffer, const uint32_t pos, const uint8_t data);
 
 
+/*! \brief      Reads the bit to be sent on the wire at the specified position of a field
+  * \details    With USE_FEC every byte of the field goes out as a 12-bits Hamming codeword
+  * \param      buffer  - Field of the frame to be sent
+  * \param      pos     - Position of the bit on the wire, which counts from left to right
+  * \return     unsigned 8-bits data - 1 or 0 */
+uint8_t readCodeBit(const uint8_t* buffer, const uint32_t pos);
+
+
+/*! \brief      Stores a bit received on the wire at the specified position of a field
+  * \details    With USE_FEC the bits are collected into "code" and every completed codeword is decoded into the field
+  * \param      buffer  - Field of the frame being received
+  * \param      pos     - Position of the bit on the wire, which counts from left to right
+  * \param      data    - 1 or 0 bit data received
+  * \param      code    - Codeword being collected
+  * \return     FEC_PENDING until a codeword is complete, then FEC_OK, FEC_CORRECTED or FEC_FAILED */
+uint8_t writeCodeBit(uint8_t* buffer, const uint32_t pos, const uint8_t data, uint16_t* code);
+
+
 /*! \brief      Prints the bits from the start position to end position
   * \param      buffer  - Set of bits to be printed on Minicom
   * \param      from    - Start position
@@ -0,0 +1,118 @@
+#pragma once
+#include "compress.h"
+
+/// Hash of the three bytes at "p"
+static uint8_t compHash(const uint8_t* p)
+{
+    return (uint8_t)(((p[0] << 4) ^ (p[1] << 2) ^ p[2]) & (COMP_HASH - 1));
+}
+
+/// Length of the match of "in[pos]" against "in[pos-distance]"
+static uint8_t compMatch(const uint8_t* in, const uint16_t length, const uint16_t pos, const uint16_t distance)
+{
+    uint8_t result = 0;
+    while(((pos + result) < length) && (result < COMP_MAX_MATCH) && (in[(pos+result)] == in[(pos+result-distance)]))
+        result++;
+    return result;
+}
+
+uint16_t compEncode(const uint8_t* in, const uint16_t length, uint8_t* out, const uint16_t limit)
+{
+    uint16_t table[COMP_HASH];
+    uint16_t pos = 0, size = 0;
+
+    for(uint8_t i=0; i<COMP_HASH; i++)
+        table[i] = 0xffff;
+
+    while(pos < length)
+    {
+        uint8_t best = 0;
+        uint16_t distance = 0;
+
+        if((pos + COMP_MIN_MATCH) <= length)
+        {
+            uint8_t h = compHash(&in[pos]);
+            uint16_t candidate = table[h];
+            table[h] = pos;
+
+            if((candidate != 0xffff) && ((pos - candidate) <= COMP_WINDOW))
+            {
+                best = compMatch(in, length, pos, (pos - candidate));
+                distance = pos - candidate;
+            }
+            if(pos > 0)
+            {
+                uint8_t run = compMatch(in, length, pos, 1);
+                if(run > best)
+                {
+                    best = run;
+                    distance = 1;
+                }
+            }
+        }
+
+        if(best >= COMP_MIN_MATCH)
+        {
+            if((size + 2) >= limit)
+                return 0;
+            out[size++] = COMP_MATCH | (best - COMP_MIN_MATCH);
+            out[size++] = (uint8_t)distance;
+            pos += best;
+        }
+        else if(in[pos] < COMP_MATCH)
+        {
+            if((size + 1) >= limit)
+                return 0;
+            out[size++] = in[pos++];
+        }
+        else
+        {
+            uint8_t count = 0;
+            while(((pos + count) < length) && (in[(pos+count)] >= COMP_MATCH) && (count < COMP_MAX_RAW))
+                count++;
+            if((size + 1 + count) >= limit)
+                return 0;
+            out[size++] = COMP_RAW | (count - 1);
+            for(uint8_t i=0; i<count; i++)
+                out[size++] = in[pos++];
+        }
+    }
+    return size;
+}
+
+uint16_t compDecode(const uint8_t* in, const uint16_t length, uint8_t* out, const uint16_t limit)
+{
+    uint16_t pos = 0, size = 0;
+
+    while(pos < length)
+    {
+        uint8_t token = in[pos++];
+
+        if(token < COMP_MATCH)
+        {
+            if(size >= limit)
+                return 0;
+            out[size++] = token;
+        }
+        else if(token < COMP_RAW)
+        {
+            uint8_t count = (token & 0x3f) + COMP_MIN_MATCH;
+            if(pos >= length)
+                return 0;
+            uint8_t distance = in[pos++];
+            if((distance == 0) || (distance > size) || ((size + count) > limit))
+                return 0;
+            for(uint8_t i=0; i<count; i++, size++)
+                out[size] = out[(size-distance)];
+        }
+        else
+        {
+            uint8_t count = (token & 0x3f) + 1;
+            if(((pos + count) > length) || ((size + count) > limit))
+                return 0;
+            for(uint8_t i=0; i<count; i++)
+                out[size++] = in[pos++];
+        }
+    }
+    return size;
+}
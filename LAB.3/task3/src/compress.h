@@ -0,0 +1,42 @@
+#pragma once
+#include <stdint.h>
+#include "config.h"
+
+/// Values of the compression byte of the header
+#define COMP_NONE       0
+#define COMP_LZ         1
+
+/*!
+  * Tokens of the compressed payload - ASCII text passes as it is
+  *   0x00 - 0x7f   : Literal byte
+  *   0x80 - 0xbf   : Copy of (token - 0x80 + COMP_MIN_MATCH) bytes, followed by the distance back (1 - 255)
+  *   0xc0 - 0xff   : (token - 0xc0 + 1) raw bytes follow, for everything that is not ASCII
+  * A copy may overlap its own output, so a distance of 1 is a run of one byte
+  */
+#define COMP_MATCH      0x80
+#define COMP_RAW        0xc0
+#define COMP_MIN_MATCH  3
+#define COMP_MAX_MATCH  (COMP_MIN_MATCH + 0x3f)
+#define COMP_MAX_RAW    0x40
+#define COMP_WINDOW     255
+
+/// Entries of the match finder, indexed by a hash of three bytes - 2 bytes of stack each
+#define COMP_HASH       64
+
+/*! \brief      Compresses a block of bytes
+  * \details    Looks for one match per position only (hash candidate and the previous byte), so it runs in linear time
+  * \param      in      - Data to be compressed
+  * \param      length  - Size of the data
+  * \param      out     - Compressed data
+  * \param      limit   - Size of "out", the compression gives up once it reaches it
+  * \return     unsigned 16-bits data - Size of the compressed data, or 0 if it would not be smaller than "limit" */
+uint16_t compEncode(const uint8_t* in, const uint16_t length, uint8_t* out, const uint16_t limit);
+
+
+/*! \brief      Restores a block of bytes compressed by compEncode
+  * \param      in      - Compressed data
+  * \param      length  - Size of the compressed data
+  * \param      out     - Restored data
+  * \param      limit   - Size of "out"
+  * \return     unsigned 16-bits data - Size of the restored data, or 0 if the data is broken or does not fit */
+uint16_t compDecode(const uint8_t* in, const uint16_t length, uint8_t* out, const uint16_t limit);
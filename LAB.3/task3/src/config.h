@@ -0,0 +1,105 @@
+#pragma once
+
+/* Optional Protocol Features
+ * Every feature is turned off by default, so the node keeps speaking the plain RaspNet frame.
+ * A feature is turned on here or from the command line, e.g. "make DEFINES=-DUSE_FEC=1" */
+
+/// Hamming(12,8) forward error correction of crc, dlc and payload - every node on the ring must agree
+#ifndef USE_FEC
+#define USE_FEC                 0
+#endif
+
+/// Hop-by-hop retransmission with ACK/NACK control frames - every node on the ring must agree
+#ifndef USE_ARQ
+#define USE_ARQ                 0
+#endif
+
+/// Reliable transport (RaspNet layer 4) with ports and a sliding window - only the end nodes need it
+#ifndef USE_L4
+#define USE_L4                  0
+#endif
+
+/// Fragmentation and reassembly of messages larger than one frame - only the end nodes need it
+#ifndef USE_FRAG
+#define USE_FRAG                0
+#endif
+
+/// Jumbo frames with a 16-bits length, used on a link once the downstream neighbour announced them
+#ifndef USE_JUMBO
+#define USE_JUMBO               0
+#endif
+
+/// Aggregation of small messages into one frame per hop - every node on the ring must agree
+#ifndef USE_AGG
+#define USE_AGG                 0
+#endif
+
+/// Compression of the payload behind the header, skipped whenever it does not shrink - only the end nodes need it
+#ifndef USE_COMP
+#define USE_COMP                0
+#endif
+
+/// Hop limit that removes frames whose source is gone or duplicated - every node on the ring must agree
+#ifndef USE_TTL
+#define USE_TTL                 0
+#endif
+
+/// Source sequence numbers and a cache that drops broadcasts seen before - every node on the ring must agree
+#ifndef USE_DEDUP
+#define USE_DEDUP               0
+#endif
+
+/// Runtime address table with several own IDs and multicast groups - only the members need it
+#ifndef USE_GROUPS
+#define USE_GROUPS              0
+#endif
+
+/// Ring ID in front of every address, so frames can be bridged between rings - every node on the ring must agree
+#ifndef USE_RINGS
+#define USE_RINGS               0
+#endif
+
+/// Bridge between the ring of MY_RING and a second ring on the second port - needs USE_RINGS
+#ifndef USE_BRIDGE
+#define USE_BRIDGE              0
+#endif
+
+#if USE_BRIDGE && !USE_RINGS
+#error "USE_BRIDGE needs USE_RINGS"
+#endif
+
+/// Second ring against the direction of the first one, frames take the shorter arc - every node on the ring must agree
+#ifndef USE_DUAL
+#define USE_DUAL                0
+#endif
+
+#if USE_BRIDGE && USE_DUAL
+#error "USE_BRIDGE and USE_DUAL both need the second pin pair"
+#endif
+
+/// Separate relay and local queues in front of the transmitter with a configurable arbiter - only this node needs it
+#ifndef USE_QUEUE
+#define USE_QUEUE               0
+#endif
+
+/// Ready line to the upstream node, which holds its own frames back while the relay queue fills - needs USE_QUEUE
+#ifndef USE_FLOW
+#define USE_FLOW                0
+#endif
+
+#if USE_FLOW && !USE_QUEUE
+#error "USE_FLOW needs USE_QUEUE"
+#endif
+
+/// Token-passing MAC - frames of a node only go out while it holds the token - every node on the ring must agree
+#ifndef USE_TOKEN
+#define USE_TOKEN               0
+#endif
+
+/// TDMA - frames of a node only go out in its slot, with a ring-wide time sync - every node on the ring must agree
+#ifndef USE_TDMA
+#define USE_TDMA                0
+#endif
+
+/// Second pin pair, used by the features above that need it
+#define USE_PHY2                (USE_BRIDGE || USE_DUAL)
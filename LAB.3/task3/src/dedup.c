@@ -0,0 +1,33 @@
+#pragma once
+#include "dedup.h"
+#include "calc.c"
+#include "layer3.c"
+
+#if USE_DEDUP
+void dedupStamp(frame_t* frame)
+{
+    frame->payload[HDR_SEQ] = dedupNext;
+    if((++dedupNext) == DEDUP_NONE)
+        dedupNext = 1;
+}
+
+uint8_t dedupSeen(const frame_t* frame)
+{
+    uint8_t src = frame->payload[HDR_SRC];
+    uint8_t seq = frame->payload[HDR_SEQ];
+
+    if(seq == DEDUP_NONE)
+        return 0x00;
+
+    for(uint8_t i=0; i<DEDUP_ENTRIES; i++)
+    {
+        if((dedupSeq[i] == seq) && (dedupSrc[i] == src))
+            return 0x01;
+    }
+
+    dedupSrc[dedupHead] = src;
+    dedupSeq[dedupHead] = seq;
+    dedupHead = ((dedupHead + 1) % DEDUP_ENTRIES);
+    return 0x00;
+}
+#endif
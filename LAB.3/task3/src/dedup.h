@@ -0,0 +1,29 @@
+#pragma once
+#include "config.h"
+
+/// Broadcasts remembered by source and sequence number - 2 bytes of RAM each
+#define DEDUP_ENTRIES       16
+
+/// Sequence number of frames that do not take part, e.g. control frames
+#define DEDUP_NONE          0
+
+#if USE_DEDUP
+/// Sequence number of the next frame of this node, never DEDUP_NONE
+uint8_t dedupNext = 1;
+
+/// Ring of the last broadcasts seen, the oldest entry is overwritten first
+uint8_t dedupSrc[DEDUP_ENTRIES];
+uint8_t dedupSeq[DEDUP_ENTRIES];
+uint8_t dedupHead = 0;
+#endif
+
+/*! \brief      Gives a frame of this node the next sequence number
+  * \param      frame   - Frame to be sent
+  * \return     void */
+void dedupStamp(frame_t* frame);
+
+
+/*! \brief      Looks a received broadcast up in the cache and remembers it if it is new
+  * \param      frame   - Received broadcast
+  * \return     unsigned 8-bits data - 1 if the broadcast has been seen before, else 0 */
+uint8_t dedupSeen(const frame_t* frame);
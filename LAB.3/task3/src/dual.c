@@ -0,0 +1,81 @@
+#pragma once
+#include "interrupt.h"
+#include "dual.h"
+#include "phy2.c"
+#include "layer3.c"
+#include "stats.c"
+
+#if USE_DUAL
+void dualLearn(const frame_t* frame, const uint8_t reverse)
+{
+    uint8_t src = frame->payload[HDR_SRC];
+    uint8_t links = frame->payload[HDR_HOPS] + 1;
+
+#if USE_RINGS
+    if(!IS_MY_RING(frame->payload[HDR_SRING]))
+        return;
+#endif
+    if(src == MY_ID)
+    {
+        // Went once around the whole ring
+        if(!reverse)
+            dualRing = links;
+        return;
+    }
+    if((src == BROADCAST_ID) || (links >= dualRing))
+        return;
+
+    // Links from here to the sender along the first ring
+    uint8_t forward = reverse ? links : (dualRing - links);
+    if(forward > (dualRing - forward))
+        dualReverse[(src >> 3)] |= (1 << (src & 0x07));
+    else
+        dualReverse[(src >> 3)] &= ~(1 << (src & 0x07));
+}
+
+uint8_t dualSend(const frame_t* frame)
+{
+    uint8_t dst = frame->payload[HDR_DST];
+    frame_t* buffer;
+
+    if((dst == BROADCAST_ID) || (dst >= GROUP_FIRST) || !DUAL_REVERSE(dst))
+        return 0x00;
+#if USE_RINGS
+    if(!IS_MY_RING(frame->payload[HDR_DRING]))
+        return 0x00;
+#endif
+
+    while(!(buffer = phy2Claim()));
+    packFrame(buffer, frame);
+    if(!phy2Start())
+        return 0x00;
+    stats.dualReverse++;
+    return 0x01;
+}
+
+void dualOnFrame(frame_t* frame)
+{
+    dualLearn(frame, 1);
+
+    switch(checkAddress(frame))
+    {
+        case BROADCAST:
+            if(unpackFrame(sFrame, frame))
+                deliverFrame(sFrame);
+            // no break - a broadcast goes on like any frame for another node
+        case OTHER_MSG:
+            if(!hopFrame(frame) || !phy2Send(frame))
+                stats.dualDropped++;
+            break;
+
+        case MY_MSG:
+            if(unpackFrame(sFrame, frame))
+                deliverFrame(sFrame);
+            break;
+
+        default:
+            break;
+    }
+    phy2Release();
+}
+#endif
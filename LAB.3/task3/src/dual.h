@@ -0,0 +1,36 @@
+#pragma once
+#include "config.h"
+
+/* Dual Ring
+ * The second port runs against the first one - it sends to PREV_ID and receives from NEXT_ID.
+ * Every frame counts the links it crossed, so a node learns how far away the sender is
+ * and sends back on the shorter arc. Broadcasts and unknown destinations use the first ring. */
+
+#if USE_DUAL
+/// Nodes on the ring, learned from the hop count of the frames of this node that come back
+uint8_t dualRing = RING_SIZE;
+
+/// Direction cache - one bit per node, set if it is closer against the direction of the first ring
+uint8_t dualReverse[32];
+#define DUAL_REVERSE(id)    (dualReverse[((id) >> 3)] & (1 << ((id) & 0x07)))
+#endif
+
+/*! \brief      Learns the direction to the sender of a received frame from its hop count
+  * \param      frame   - Intact frame
+  * \param      reverse - 1 if it came in on the second port, 0 for the first one
+  * \return     void */
+void dualLearn(const frame_t* frame, const uint8_t reverse);
+
+
+/*! \brief      Sends a frame on the second port if the direction cache says its destination is closer that way
+  * \details    Waits until the second transmitter is free - must not be called from an interrupt routine,
+  *             the frame that holds it is clocked out by the timer interrupt. Called by sendFrame only.
+  * \param      frame   - Frame with a valid crc
+  * \return     unsigned 8-bits data - 1 if it went to the second port, 0 if it belongs on the first ring */
+uint8_t dualSend(const frame_t* frame);
+
+
+/*! \brief      phy2OnFrame of the dual ring - the receive path of the first port for the second one
+  * \param      frame   - Intact frame received on the second port
+  * \return     void */
+void dualOnFrame(frame_t* frame);
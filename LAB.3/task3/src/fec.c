@@ -0,0 +1,59 @@
+#pragma once
+#include "fec.h"
+
+/// Hamming positions of the data bits, MSB first
+const uint8_t _dataPos[8] = { 3, 5, 6, 7, 9, 10, 11, 12 };
+
+/// XOR of the positions of all set bits - zero for a valid codeword
+static uint8_t syndrome(const uint16_t code)
+{
+    uint8_t result = 0;
+    for(uint8_t p=1; p<=12; p++)
+    {
+        if(code & (1 << (p-1)))
+            result ^= p;
+    }
+    return result;
+}
+
+uint16_t hammingEncode(const uint8_t data)
+{
+    uint16_t code = 0;
+    for(uint8_t i=0; i<8; i++)
+    {
+        if(data & (0b10000000 >> i))
+            code |= (1 << (_dataPos[i]-1));
+    }
+
+    // Every parity bit cancels its own bit of the syndrome
+    uint8_t s = syndrome(code);
+    for(uint8_t k=0; k<4; k++)
+    {
+        if(s & (1 << k))
+            code |= (1 << ((1 << k)-1));
+    }
+    return code;
+}
+
+uint8_t hammingDecode(const uint16_t code, uint8_t* data)
+{
+    uint16_t fixed = code;
+    uint8_t result = FEC_OK;
+
+    uint8_t s = syndrome(code);
+    if(s > 12)
+        result = FEC_FAILED;
+    else if(s > 0)
+    {
+        fixed ^= (1 << (s-1));
+        result = FEC_CORRECTED;
+    }
+
+    *data = 0;
+    for(uint8_t i=0; i<8; i++)
+    {
+        if(fixed & (1 << (_dataPos[i]-1)))
+            *data |= (0b10000000 >> i);
+    }
+    return result;
+}
@@ -0,0 +1,28 @@
+#pragma once
+#include <stdint.h>
+#include "config.h"
+
+#define FEC_OK          0
+#define FEC_CORRECTED   1
+#define FEC_FAILED      2
+#define FEC_PENDING     3
+
+/// Bits on the wire per byte of crc, dlc and payload
+#if USE_FEC
+#define CODE_BITS       12
+#else
+#define CODE_BITS       8
+#endif
+
+/*! \brief      Encodes one byte into a Hamming(12,8) codeword
+  * \details    Bit (p-1) of the codeword holds Hamming position p, so parity bits sit at positions 1, 2, 4 and 8
+  * \param      data    - Byte to be encoded
+  * \return     unsigned 16-bits data - 12-bits codeword */
+uint16_t hammingEncode(const uint8_t data);
+
+
+/*! \brief      Decodes a Hamming(12,8) codeword and corrects up to one flipped bit
+  * \param      code    - 12-bits codeword
+  * \param      data    - Decoded byte
+  * \return     FEC_OK, FEC_CORRECTED or FEC_FAILED */
+uint8_t hammingDecode(const uint16_t code, uint8_t* data);
@@ -0,0 +1,35 @@
+#pragma once
+#include "flow.h"
+#include "stats.c"
+
+#if USE_FLOW
+void flowSetup()
+{
+    FLOW_SETUP_PINS();
+    FLOW_READY();
+}
+
+void flowUpdate(const uint8_t waiting)
+{
+    if(waiting >= FLOW_HIGH_WATER)
+    {
+        if(!flowPaused)
+            stats.flowPauses++;
+        flowPaused = 1;
+        FLOW_PAUSE();
+    }
+    else
+    {
+        flowPaused = 0;
+        FLOW_READY();
+    }
+}
+
+uint8_t flowMayInject(const uint8_t waiting)
+{
+    if((waiting < FLOW_HIGH_WATER) && FLOW_DOWNSTREAM_READY())
+        return 0x01;
+    stats.flowHeld++;
+    return 0x00;
+}
+#endif
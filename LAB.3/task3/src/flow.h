@@ -0,0 +1,38 @@
+#pragma once
+#include "config.h"
+#include "hal.h"
+
+/* Back-Pressure
+ * A ready line runs against the ring from every node to its upstream neighbour.
+ * A node pulls it low while its relay queue holds FLOW_HIGH_WATER frames or more,
+ * and then the upstream node sends only relayed frames, none of its own.
+ * A pause frame would need N-1 hops on a one-way ring, the line takes effect at once. */
+
+/* Ready Lines
+ * FLOW_READY, FLOW_PAUSE and FLOW_DOWNSTREAM_READY come from the backend of hal.h,
+ * a pull-up keeps the downstream line ready if nothing is connected */
+
+/// Relayed frames waiting before upstream is paused - the frame still in flight takes the room the waiting one left,
+/// if it finds none it is dropped and counted like any relay without room
+#define FLOW_HIGH_WATER             1
+
+#if USE_FLOW
+/// Level of the ready line
+uint8_t flowPaused = 0;
+#endif
+
+/*! \brief      Setup for the ready lines
+  * \return     void */
+void flowSetup();
+
+
+/*! \brief      Drives the ready line from the fill level of the relay queue
+  * \param      waiting - Frames in the relay queue
+  * \return     void */
+void flowUpdate(const uint8_t waiting);
+
+
+/*! \brief      Tells whether this node may put a frame of its own on the ring
+  * \param      waiting - Frames in the relay queue
+  * \return     unsigned 8-bits data - 1 if the downstream node is ready and the relay queue below FLOW_HIGH_WATER */
+uint8_t flowMayInject(const uint8_t waiting);
@@ -0,0 +1,151 @@
+#pragma once
+#include "interrupt.h"
+#include "fragment.h"
+#include "jumbo.h"
+#include "calc.c"
+#include "layer3.c"
+#include "stats.c"
+
+#if USE_FRAG
+void fragPrintMessage(const uint8_t src, const uint8_t* data, const uint16_t length)
+{
+    printMsg("MESSAGE FROM ", 13);
+    printNumber(src);
+    printMsg(" : ", 3);
+    for(uint16_t i=0; i<length; i++)
+        uart_transmit(data[i]);
+    uart_changeLine();
+}
+
+uint8_t fragProvide(uint8_t* buffer, const uint16_t size)
+{
+    for(uint8_t i=0; i<FRAG_SLOTS; i++)
+    {
+        if(!fragSlots[i].buffer)
+        {
+            fragSlots[i].size = size;
+            fragSlots[i].busy = 0;
+            fragSlots[i].buffer = buffer;
+            return 0x01;
+        }
+    }
+    return 0x00;
+}
+
+uint8_t fragWithdraw(const uint8_t* buffer)
+{
+    uint8_t taken = 0x00;
+    HAL_IRQ_OFF();
+    for(uint8_t i=0; i<FRAG_SLOTS; i++)
+    {
+        if((fragSlots[i].buffer == buffer) && !fragSlots[i].busy)
+        {
+            fragSlots[i].buffer = 0;
+            taken = 0x01;
+        }
+    }
+    HAL_IRQ_ON();
+    return taken;
+}
+
+uint8_t fragSend(const uint8_t dst, const uint8_t* data, const uint16_t length)
+{
+    // Longer messages would overflow the offset into the "more fragments" flag
+    if((length == 0) || (length > FRAG_MAX_LENGTH))
+        return 0x00;
+
+    // Id 0 is left to plain frames
+    if(!fragNextId)
+        fragNextId++;
+    uint8_t id = fragNextId++;
+    uint16_t step = FRAG_CHUNK;
+
+    for(uint16_t offset=0; offset<length; offset+=step)
+    {
+        uint16_t chunk = ((length - offset) > step) ? step : (length - offset);
+        uint8_t more = ((offset + chunk) < length) ? FRAG_MORE : 0x00;
+
+        // Built in the frame of the main loop, a frame_t on the stack does not fit next to the reassembly buffers
+        clearFrame(myFrame);
+        myFrame->payload[HDR_DST] = dst;
+        myFrame->payload[HDR_SRC] = MY_ID;
+        myFrame->payload[FRAG_ID] = id;
+        myFrame->payload[FRAG_OFFSET] = (more | (offset >> 8));
+        myFrame->payload[FRAG_OFFSET+1] = (offset & 0xff);
+        for(uint16_t i=0; i<chunk; i++)
+            myFrame->payload[(HDR_SIZE+i)] = data[(offset+i)];
+        SET_LENGTH(myFrame, (HDR_SIZE + chunk));
+        sendFrame(myFrame);
+    }
+    return 0x01;
+}
+
+void fragReceive(const frame_t* frame)
+{
+    uint8_t src = frame->payload[HDR_SRC];
+    uint8_t id = frame->payload[FRAG_ID];
+    uint8_t more = (frame->payload[FRAG_OFFSET] & FRAG_MORE);
+    uint16_t offset = (((frame->payload[FRAG_OFFSET] & ~FRAG_MORE) << 8) | frame->payload[FRAG_OFFSET+1]);
+    uint16_t chunk = (FRAME_LENGTH(frame) - HDR_SIZE);
+
+    reassembly_t* r = 0;
+    for(uint8_t i=0; i<FRAG_SLOTS; i++)
+    {
+        if(fragSlots[i].busy && (fragSlots[i].src == src) && (fragSlots[i].id == id))
+            r = &fragSlots[i];
+    }
+
+    // A new message takes the first idle buffer
+    if((!r) && (offset == 0))
+    {
+        for(uint8_t i=0; i<FRAG_SLOTS; i++)
+        {
+            if(fragSlots[i].buffer && !fragSlots[i].busy)
+            {
+                r = &fragSlots[i];
+                r->busy = 1;
+                r->src = src;
+                r->id = id;
+                r->next = 0;
+                break;
+            }
+        }
+    }
+
+    // No buffer, a gap after a lost fragment, or a message larger than its buffer
+    if((!r) || (offset != r->next) || ((offset + chunk) > r->size))
+    {
+        stats.fragDropped++;
+        if(r)
+            r->busy = 0;
+        return;
+    }
+
+    for(uint16_t i=0; i<chunk; i++)
+        r->buffer[(offset+i)] = frame->payload[(HDR_SIZE+i)];
+    r->next = (offset + chunk);
+    r->last = ticks;
+
+    if(!more)
+    {
+        stats.fragMessages++;
+        if(fragOnMessage)
+            fragOnMessage(src, r->buffer, r->next);
+        r->busy = 0;
+    }
+}
+
+void fragPoll()
+{
+    for(uint8_t i=0; i<FRAG_SLOTS; i++)
+    {
+        HAL_IRQ_OFF();
+        if(fragSlots[i].busy && ((ticks - fragSlots[i].last) > (FRAG_TIMEOUT_BITS*BIT_TICKS)))
+        {
+            fragSlots[i].busy = 0;
+            stats.fragTimeouts++;
+        }
+        HAL_IRQ_ON();
+    }
+}
+#endif
@@ -0,0 +1,89 @@
+#pragma once
+#include "config.h"
+
+/// Fragment header - message number, then "more fragments" flag and 15-bits byte offset.
+/// An all-zero header is a plain frame of sendFrame - fragSend numbers its messages from 1, so a message that
+/// fits into one frame still goes to fragOnMessage.
+#define FRAG_ID             (HDR_FRAG + 0)
+#define FRAG_OFFSET         (HDR_FRAG + 1)
+#define FRAG_MORE           0x80
+
+/// Longest message the 15-bits offset can address
+#define FRAG_MAX_LENGTH     0x7fff
+
+/// Data bytes carried by one fragment - jumbo frames once the downstream neighbour takes them
+#define FRAG_CHUNK          (LINK_PAYLOAD() - HDR_SIZE)
+
+/// Messages reassembled at the same time - each one needs a buffer from fragProvide
+#define FRAG_SLOTS          2
+
+/// Reassembly buffer of the console
+#define FRAG_MESSAGE_SIZE   300
+
+/// Bit times an incomplete message may wait for its next fragment before its buffer is released
+#define FRAG_TIMEOUT_BITS   (RING_SIZE * 2040UL * 2)
+
+/// Checks whether a frame came from fragSend
+#define FRAG_IS_PART(frame) ((frame)->payload[FRAG_ID] || (frame)->payload[FRAG_OFFSET] || \
+                             (frame)->payload[FRAG_OFFSET+1])
+
+typedef struct
+{
+    uint8_t* buffer;                    ///< Caller-provided, 0 for an unused slot
+    uint16_t size;
+    uint8_t busy;                       ///< 1 while a message is being reassembled
+    uint8_t src;
+    uint8_t id;
+    uint16_t next;                      ///< Offset of the next expected fragment
+    uint32_t last;                      ///< Tick of the last fragment
+} reassembly_t;
+
+#if USE_FRAG
+reassembly_t fragSlots[FRAG_SLOTS];
+uint8_t fragNextId = 0;
+#endif
+
+/*! \brief      Application callback for every completely reassembled message
+  * \details    Runs inside the receive interrupt. The buffer goes back to the pool afterwards. */
+void (*fragOnMessage)(const uint8_t src, const uint8_t* data, const uint16_t length);
+
+
+/*! \brief      Default fragOnMessage - prints the sender and the message on Minicom
+  * \return     void */
+void fragPrintMessage(const uint8_t src, const uint8_t* data, const uint16_t length);
+
+
+/*! \brief      Hands a buffer over to the reassembly
+  * \param      buffer  - Buffer for one message
+  * \param      size    - Largest message the buffer takes
+  * \return     unsigned 8-bits data - 1 if taken, 0 if every slot has a buffer already */
+uint8_t fragProvide(uint8_t* buffer, const uint16_t size);
+
+
+/*! \brief      Takes a buffer of fragProvide back, e.g. to fill it with a message of this node
+  * \param      buffer  - Buffer handed over before
+  * \return     unsigned 8-bits data - 1 if taken back, 0 while a message is reassembled into it or if unknown */
+uint8_t fragWithdraw(const uint8_t* buffer);
+
+
+/*! \brief      Sends a message of 1 to FRAG_MAX_LENGTH bytes as a sequence of fragments
+  * \details    Waits for the transmitter like sendFrame - must not be called from an interrupt routine.
+  *             The fragments are built in myFrame, which the console fills again before every message.
+  * \param      dst     - Destination node or BROADCAST_ID
+  * \param      data    - Message
+  * \param      length  - Size of the message
+  * \return     unsigned 8-bits data - 1 if sent, 0 if the length is 0 or beyond FRAG_MAX_LENGTH */
+uint8_t fragSend(const uint8_t dst, const uint8_t* data, const uint16_t length);
+
+
+/*! \brief      Copies the data of a received fragment straight into its reassembly buffer
+  * \details    Fragments have to arrive in order, which the ring keeps unless a frame is lost
+  * \param      frame   - Received fragment
+  * \return     void */
+void fragReceive(const frame_t* frame);
+
+
+/*! \brief      Releases the buffers of messages whose next fragment did not arrive in time
+  * \details    Called from the main loop
+  * \return     void */
+void fragPoll();
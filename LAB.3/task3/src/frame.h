@@ -0,0 +1,38 @@
+#pragma once
+#include <stdint.h>
+#include "config.h"
+
+/// Largest payload of a frame with a one byte DLC, which every node takes
+#define LEGACY_PAYLOAD  251
+
+/// Largest payload of a jumbo frame. The 2 KB of RAM hold the four frame buffers of interrupt.h (4*294 B),
+/// the other globals and constant strings (about 500 B, host estimate of a USE_JUMBO build) and the stack
+/// of the main loop under the interrupts, which keeps about 370 B. Every feature with buffers of its own
+/// (USE_ARQ, USE_QUEUE, USE_AGG, USE_PHY2) takes from that stack and needs a smaller jumbo size or none.
+#define JUMBO_PAYLOAD   288
+
+/// Largest payload of one frame and the bytes of its DLC field
+#if USE_JUMBO
+#define FRAME_PAYLOAD   JUMBO_PAYLOAD
+#define DLC_SIZE        2
+#else
+#define FRAME_PAYLOAD   LEGACY_PAYLOAD
+#define DLC_SIZE        1
+#endif
+
+/// Packet Format
+typedef struct
+{
+    uint8_t crc[4];
+    uint8_t dlc[DLC_SIZE];
+    uint8_t payload[FRAME_PAYLOAD];
+} frame_t;
+
+/// Reads and writes the payload size - the DLC is big endian, a legacy frame only uses its last byte
+#if USE_JUMBO
+#define FRAME_LENGTH(frame)         ((uint16_t)(((frame)->dlc[0] << 8) | (frame)->dlc[1]))
+#define SET_LENGTH(frame, length)   ((frame)->dlc[0] = ((length) >> 8), (frame)->dlc[1] = ((length) & 0xff))
+#else
+#define FRAME_LENGTH(frame)         ((frame)->dlc[0])
+#define SET_LENGTH(frame, length)   ((frame)->dlc[0] = (length))
+#endif
@@ -0,0 +1,9 @@
+#pragma once
+#include "hal.h"
+
+#if HAL_POSIX
+#include "hal_posix.c"
+#else
+#include "init.c"
+#include "uart.c"
+#endif
@@ -0,0 +1,25 @@
+#pragma once
+#include <stdint.h>
+
+/* Hardware Abstraction Layer
+ * The stack only touches the hardware through the names below, so the same calc.c, layer3.c and
+ * state machine build for the ATMega and, with "-DHAL_POSIX=1", as a Linux library.
+ *
+ * Every backend provides
+ *  - Pins          : SEND_DATA_ONE/ZERO, RECEIVED_DATA, PIN_CHANGE, HAL_RX_PINS with HAL_RX_CLOCK,
+ *                    the PHY2_* pins of the second port and the FLOW_* ready lines
+ *  - Timer tick    : interrupt_setup and the handlers HAL_ISR_TIMER_A, HAL_ISR_TIMER_B and HAL_ISR_PIN_CHANGE
+ *  - UART          : uart_init, uart_transmit, uart_receive, uart_available and HAL_DELAY_MS
+ *  - Flash         : HAL_FLASH_STR for constant strings and HAL_FLASH_BYTE to read them
+ *  - Critical      : HAL_IRQ_OFF/ON and HAL_IRQ_SAVE/RESTORE with the semantics of cli, sei and SREG */
+
+/// Backend of the build - 0 for the ATMega, 1 for a POSIX host
+#ifndef HAL_POSIX
+#define HAL_POSIX               0
+#endif
+
+#if HAL_POSIX
+#include "hal_posix.h"
+#else
+#include "hal_avr.h"
+#endif
@@ -0,0 +1,63 @@
+#pragma once
+#define F_CPU 12000000UL
+#define BAUD 19200UL
+#define MYUBRR (F_CPU/(16*BAUD)-1)
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/setbaud.h>
+#include <util/delay.h>
+#include <avr/pgmspace.h>
+
+/* AVR Backend
+ * The registers of the ATMega328P - init.c and uart.c hold the setup and the serial port */
+
+// Turns on LEDs : PB4 and PB5
+//#define LED_A_TOGGLE()              (PORTB ^= (1 << PB5))
+//#define LED_B_TOGGLE()              (PORTB ^= (1 << PB4))
+
+/// Sends Logical 1 Data-Signal through "PB2 Pin"
+#define SEND_DATA_ONE()             (PORTB |= (1 << PB2))
+
+/// Sends Logical 0 Data-Signal through "PB2 Pin"
+#define SEND_DATA_ZERO()            (PORTB &= ~(1 << PB2))
+
+/// Receives Data-Signal through "PD4 Pin"
+#define RECEIVED_DATA()             (PIND & (1 << PD4))
+
+/// Sends Clock-Signal for Pin-Change Interrupt through "PB1 Pin"
+#define PIN_CHANGE()                (PORTB ^= (1 << PB1))
+
+/// Levels of the receive pins and the clock pins behind the pin-change interrupt - "PD3 Pin" and "PD5 Pin"
+#define HAL_RX_PINS()               (PIND)
+#define HAL_RX_CLOCK                (1 << PD3)
+#define HAL_RX2_CLOCK               (1 << PD5)
+
+/// Second port - Clock-Signal through "PB3 Pin", Data-Signal through "PB4 Pin" and "PD6 Pin"
+#define PHY2_CLOCK_CHANGE()         (PORTB ^= (1 << PB3))
+#define PHY2_DATA_ONE()             (PORTB |= (1 << PB4))
+#define PHY2_DATA_ZERO()            (PORTB &= ~(1 << PB4))
+#define PHY2_RECEIVED_DATA()        ((PIND & (1 << PD6)) ? 1 : 0)
+#define PHY2_SETUP_PINS()           do { DDRB |= (1 << DDB3) | (1 << DDB4); DDRD &= ~((1 << DDD5) | (1 << DDD6)); PCMSK2 |= (1 << PCINT21); } while(0)
+
+/// Ready lines - to the upstream node through "PC0 Pin", from the downstream node through "PC1 Pin" with pull-up
+#define FLOW_READY()                (PORTC |= (1 << PC0))
+#define FLOW_PAUSE()                (PORTC &= ~(1 << PC0))
+#define FLOW_DOWNSTREAM_READY()     (PINC & (1 << PC1))
+#define FLOW_SETUP_PINS()           do { DDRC |= (1 << DDC0); DDRC &= ~(1 << DDC1); PORTC |= (1 << PC1); } while(0)
+
+/// Interrupt handlers - compare match A and B of timer 0 and the pin-change interrupt of port D
+#define HAL_ISR_TIMER_A             ISR(TIMER0_COMPA_vect)
+#define HAL_ISR_TIMER_B             ISR(TIMER0_COMPB_vect)
+#define HAL_ISR_PIN_CHANGE          ISR(PCINT2_vect)
+
+/// Global interrupt flag
+#define HAL_IRQ_OFF()               cli()
+#define HAL_IRQ_ON()                sei()
+#define HAL_IRQ_SAVE(state)         do { (state) = SREG; cli(); } while(0)
+#define HAL_IRQ_RESTORE(state)      (SREG = (state))
+
+#define HAL_DELAY_MS(ms)            _delay_ms(ms)
+
+/// Strings that stay in flash instead of being copied to RAM at startup, read byte by byte
+#define HAL_FLASH_STR(str)          PSTR(str)
+#define HAL_FLASH_BYTE(ptr)         pgm_read_byte(ptr)
@@ -0,0 +1,141 @@
+#pragma once
+#include <stdio.h>
+#include <poll.h>
+#include <time.h>
+#include "hal_posix.h"
+#include "init.h"
+#include "uart.h"
+
+uint8_t halIrqOff()
+{
+    if(halLocked && pthread_equal(halOwner, pthread_self()))
+        return 0x00;
+    pthread_mutex_lock(&halLock);
+    halOwner = pthread_self();
+    halLocked = 1;
+    return 0x01;
+}
+
+void halIrqOn()
+{
+    if(!halLocked || !pthread_equal(halOwner, pthread_self()))
+        return;
+    halLocked = 0;
+    pthread_mutex_unlock(&halLock);
+}
+
+void halCompareB()
+{
+    uint8_t state = halIrqOff();
+    halTimerB();
+    HAL_IRQ_RESTORE(state);
+}
+
+void halCompareA()
+{
+    uint8_t state = halIrqOff();
+    halTimerA();
+    HAL_IRQ_RESTORE(state);
+}
+
+void halTick()
+{
+    halCompareB();
+    halCompareA();
+}
+
+void halDrive(const uint8_t pins)
+{
+    uint8_t state = halIrqOff();
+    uint8_t changed = ((halIn ^ pins) & halPinMask);
+    halIn = pins;
+    if(changed)
+        halPinChange();
+    HAL_IRQ_RESTORE(state);
+}
+
+/// Timer thread of interrupt_setup - one halTick per HAL_TICK_US of real time
+void* halTimer(void* arg)
+{
+    struct timespec next;
+    clock_gettime(CLOCK_MONOTONIC, &next);
+    for(;;)
+    {
+        next.tv_nsec += (HAL_TICK_US * 1000L);
+        if(next.tv_nsec >= 1000000000L)
+        {
+            next.tv_sec++;
+            next.tv_nsec -= 1000000000L;
+        }
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, 0);
+        halTick();
+    }
+    return 0;
+}
+
+void io_setup()
+{
+    halOut = 0;
+}
+
+void interrupt_setup()
+{
+    pthread_t thread;
+    if(!halRealTime)
+        return;
+    pthread_create(&thread, 0, halTimer, 0);
+    pthread_detach(thread);
+}
+
+void pin_change_setup()
+{
+    halPinMask |= HAL_PIN_CLOCK;
+}
+
+void uart_init(unsigned long ubrr)
+{
+    setvbuf(stdout, 0, _IONBF, 0);
+}
+
+/// Character taken by uart_available from the hook of an emulator, -1 if none
+int16_t halUartNext = -1;
+
+void uart_transmit(unsigned char data)
+{
+    if(halUartTx)
+        halUartTx(halNode, data);
+    else
+        putchar(data);
+}
+
+unsigned char uart_receive()
+{
+    if(!halUartRx)
+    {
+        int c = getchar();
+        return (c == EOF) ? 0 : (unsigned char)c;
+    }
+    while(!uart_available())
+        HAL_DELAY_MS(1);
+    unsigned char data = (unsigned char)halUartNext;
+    halUartNext = -1;
+    return data;
+}
+
+uint8_t uart_available()
+{
+    if(halUartRx)
+    {
+        if(halUartNext < 0)
+            halUartNext = halUartRx(halNode);
+        return (halUartNext >= 0) ? 0x01 : 0x00;
+    }
+    struct pollfd fd = { 0, POLLIN, 0 };
+    return (poll(&fd, 1, 0) > 0) ? 0x01 : 0x00;
+}
+
+void uart_changeLine()
+{
+    uart_transmit('\n');
+    uart_transmit('\r');
+}
@@ -0,0 +1,118 @@
+#pragma once
+#include <stdint.h>
+#include <unistd.h>
+#include <pthread.h>
+
+/* POSIX Backend
+ * Runs the stack in a Linux process, e.g. as a library for tests and benchmarks.
+ * The pins are two bytes of memory, halOut of one node is meant to be wired to halIn of the next one,
+ * which is why every output sits on the same bit as the input it drives.
+ * The interrupts are whichever thread calls halTick and halDrive, or the timer thread of interrupt_setup,
+ * and the global interrupt flag is a mutex, so code between HAL_IRQ_OFF and HAL_IRQ_ON never meets a handler. */
+
+/// Output pins - clock and data of both ports and the ready line to the upstream node
+#define HAL_PIN_CLOCK               0x01
+#define HAL_PIN_DATA                0x02
+#define HAL_PIN_CLOCK2              0x04
+#define HAL_PIN_DATA2               0x08
+#define HAL_PIN_READY               0x10
+
+/// Levels of the pins - the ready line is high if nothing is connected, as with the pull-up
+volatile uint8_t halOut = 0;
+volatile uint8_t halIn = HAL_PIN_READY;
+
+/// Input pins behind the pin-change interrupt
+volatile uint8_t halPinMask = 0;
+
+#define SEND_DATA_ONE()             (halOut |= HAL_PIN_DATA)
+#define SEND_DATA_ZERO()            (halOut &= ~HAL_PIN_DATA)
+#define RECEIVED_DATA()             (halIn & HAL_PIN_DATA)
+#define PIN_CHANGE()                (halOut ^= HAL_PIN_CLOCK)
+
+#define HAL_RX_PINS()               (halIn)
+#define HAL_RX_CLOCK                HAL_PIN_CLOCK
+#define HAL_RX2_CLOCK               HAL_PIN_CLOCK2
+
+#define PHY2_CLOCK_CHANGE()         (halOut ^= HAL_PIN_CLOCK2)
+#define PHY2_DATA_ONE()             (halOut |= HAL_PIN_DATA2)
+#define PHY2_DATA_ZERO()            (halOut &= ~HAL_PIN_DATA2)
+#define PHY2_RECEIVED_DATA()        ((halIn & HAL_PIN_DATA2) ? 1 : 0)
+#define PHY2_SETUP_PINS()           (halPinMask |= HAL_PIN_CLOCK2)
+
+#define FLOW_READY()                (halOut |= HAL_PIN_READY)
+#define FLOW_PAUSE()                (halOut &= ~HAL_PIN_READY)
+#define FLOW_DOWNSTREAM_READY()     (halIn & HAL_PIN_READY)
+#define FLOW_SETUP_PINS()           FLOW_READY()
+
+/// Interrupt handlers are plain functions, called by halTick and halDrive
+#define HAL_ISR_TIMER_A             void halTimerA()
+#define HAL_ISR_TIMER_B             void halTimerB()
+#define HAL_ISR_PIN_CHANGE          void halPinChange()
+
+void halTimerA();
+void halTimerB();
+void halPinChange();
+
+#define HAL_IRQ_OFF()               halIrqOff()
+#define HAL_IRQ_ON()                halIrqOn()
+#define HAL_IRQ_SAVE(state)         ((state) = halIrqOff())
+#define HAL_IRQ_RESTORE(state)      do { if(state) halIrqOn(); } while(0)
+
+#define HAL_DELAY_MS(ms)            usleep((ms)*1000UL)
+
+/// Flash and RAM are the same on the host
+#define HAL_FLASH_STR(str)          (str)
+#define HAL_FLASH_BYTE(ptr)         (*(ptr))
+
+/// The serial port is stdin and stdout, the baud rate does not matter
+#define MYUBRR                      0
+
+/// 1 if interrupt_setup starts a timer thread, an emulator clears it and calls halTick itself
+volatile uint8_t halRealTime = 1;
+
+/// Serial port of an emulator - while set, the hooks take the place of stdin and stdout
+/// halUartRx returns -1 if no character is waiting, halNode tells the emulator which node it is
+volatile uint8_t halNode = 0;
+void (*halUartTx)(const uint8_t node, const unsigned char data);
+int16_t (*halUartRx)(const uint8_t node);
+
+/// Real time of one timer period in microseconds - 256*48 cycles at 12 MHz
+#define HAL_TICK_US                 1024
+
+/// Global interrupt flag - the mutex is held by the thread that cleared it
+pthread_mutex_t halLock = PTHREAD_MUTEX_INITIALIZER;
+pthread_t halOwner;
+volatile uint8_t halLocked = 0;
+
+
+/*! \brief      Clears the global interrupt flag, like cli
+  * \return     unsigned 8-bits data - 1 if the flag was set before, for HAL_IRQ_RESTORE */
+uint8_t halIrqOff();
+
+
+/*! \brief      Sets the global interrupt flag, like sei
+  * \return     void */
+void halIrqOn();
+
+
+/*! \brief      Runs compare match B at the start of a timer period - the clock interrupt, which toggles the clock pins
+  * \return     void */
+void halCompareB();
+
+
+/*! \brief      Runs compare match A at the end of a timer period - the transmit interrupt, which sets the data pins
+  * \details    A receiver wired to this node samples the data of the previous bit on the clock edge of halCompareB,
+  *             so an emulator passes the pins on after each of the two
+  * \return     void */
+void halCompareA();
+
+
+/*! \brief      Runs one timer period - halCompareB and then halCompareA
+  * \return     void */
+void halTick();
+
+
+/*! \brief      Changes the levels of the input pins and runs the pin-change interrupt if a clock pin moved
+  * \param      pins    - New levels of the input pins, e.g. halOut of the upstream node
+  * \return     void */
+void halDrive(const uint8_t pins);
@@ -1,5 +1,5 @@
 #pragma once
-#include <avr/io.h>
+#include "hal.h"
 
 void io_setup();
 void interrupt_setup();
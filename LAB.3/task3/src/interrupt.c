@@ -1,22 +1,287 @@
 #pragma once
-#include <avr/interrupt.h>
 #include "interrupt.h"
 #include "calc.c"
-#include "uart.c"
+#include "hal.c"
 #include "layer3.c"
+#include "stats.c"
+#include "arq.c"
+#include "transport.c"
+#include "fragment.c"
+#include "jumbo.c"
+#include "aggregate.c"
+#include "dedup.c"
+#include "bridge.c"
+#include "dual.c"
+#include "queue.c"
+#include "token.c"
+#include "tdma.c"
+
+void linkInit()
+{
+    rFrame = &_rFrame;
+    tFrame = &_tFrame;
+    myFrame = &_myFrame;
+    sFrame = &_sFrame;
+
+    tFlag = FLAG_IDLE;
+    rFlag = FLAG_DETECTING_PREAMBLE;
+    pFlag = PRIORITY_IDLE;
+
+    clearFrame(tFrame);
+    clearFrame(myFrame);
+    clearFrame(rFrame);
+#if USE_GROUPS
+    // checkAddress knows this node only from the address table
+    addrInit();
+#endif
+}
+
+void abortReceive()
+{
+    clearFrame(rFrame);
+    *rQueue = RX_QUEUE_RESET;
+    rCounter = 0;
+    rFlag = FLAG_DETECTING_PREAMBLE;
+
+    stats.rxTimeouts++;
+    rAbortTick = ticks;
+    rRecovering = 1;
+}
+
+void countCode(const uint8_t status)
+{
+#if USE_FEC
+    if(status == FEC_CORRECTED)
+        stats.fecCorrected++;
+    else if(status == FEC_FAILED)
+        stats.fecFailed++;
+#endif
+}
+
+uint8_t hopFrame(frame_t* frame)
+{
+#if USE_TTL
+    // Orphaned and looping frames end here instead of circling the ring forever
+    if(frame->payload[HDR_TTL] <= 1)
+    {
+        stats.ttlExpired++;
+        return 0x00;
+    }
+    frame->payload[HDR_TTL]--;
+#endif
+#if USE_DUAL
+    frame->payload[HDR_HOPS]++;
+#endif
+#if USE_TTL || USE_DUAL
+    clearBuffer(frame->crc, 32);
+    makeCrc(frame->crc, frame->payload, FRAME_LENGTH(frame), _polynomial, GENERATE);
+#endif
+    return 0x01;
+}
+
+void relayFrame()
+{
+    if(!hopFrame(rFrame))
+        return;
+#if USE_QUEUE
+    if(!queueRelay(rFrame))
+        stats.queueRelayDropped++;
+    return;
+#else
+    // Without a relay queue the relay takes the transmitter, a frame still on the wire is cut off there
+    if((pFlag == PRIORITY_SEND) || (pFlag == PRIORITY_RELAY))
+        stats.txCut++;
+#endif
+    pFlag = PRIORITY_LOCK;
+    *tFrame = *rFrame;
+    tCounter = 0;
+#if USE_ARQ
+    if(!arqStamp(tFrame))
+    {
+        stats.arqDropped++;
+        clearFrame(tFrame);
+        pFlag = PRIORITY_IDLE;
+        return;
+    }
+#endif
+    tFlag = FLAG_SENDING_PREAMBLE;
+    pFlag = PRIORITY_RELAY;
+}
+
+void packFrame(frame_t* dst, const frame_t* src)
+{
+    *dst = *src;
+#if USE_COMP
+    uint16_t length = FRAME_LENGTH(src);
+    if(length <= HDR_SIZE)
+        return;
+
+    uint16_t size = compEncode(&src->payload[HDR_SIZE], (length - HDR_SIZE), &dst->payload[HDR_SIZE], (length - HDR_SIZE));
+    if(size == 0)
+    {
+        // Incompressible - the copy above still holds the plain payload
+        for(uint16_t i=HDR_SIZE; i<length; i++)
+            dst->payload[i] = src->payload[i];
+        stats.compSkipped++;
+        return;
+    }
+
+    dst->payload[HDR_COMP] = COMP_LZ;
+    for(uint16_t i=(HDR_SIZE + size); i<length; i++)
+        dst->payload[i] = 0;
+    SET_LENGTH(dst, (HDR_SIZE + size));
+    clearBuffer(dst->crc, 32);
+    makeCrc(dst->crc, dst->payload, FRAME_LENGTH(dst), _polynomial, GENERATE);
+    stats.compPacked++;
+    stats.compSaved += (length - HDR_SIZE - size);
+#endif
+}
+
+uint8_t unpackFrame(frame_t* dst, const frame_t* src)
+{
+#if USE_COMP
+    if(src->payload[HDR_COMP] == COMP_LZ)
+    {
+        for(uint8_t i=0; i<HDR_SIZE; i++)
+            dst->payload[i] = src->payload[i];
+        uint16_t size = compDecode(&src->payload[HDR_SIZE], (FRAME_LENGTH(src) - HDR_SIZE), &dst->payload[HDR_SIZE], (FRAME_PAYLOAD - HDR_SIZE));
+        if(size == 0)
+        {
+            stats.compFailed++;
+            return 0x00;
+        }
+        dst->payload[HDR_COMP] = COMP_NONE;
+        SET_LENGTH(dst, (HDR_SIZE + size));
+        return 0x01;
+    }
+#endif
+    *dst = *src;
+    return 0x01;
+}
+
+void sendFrame(frame_t* frame)
+{
+#if USE_TTL
+    if(frame->payload[HDR_TTL] == 0)
+        frame->payload[HDR_TTL] = ttlStart;
+#endif
+#if USE_DEDUP
+    dedupStamp(frame);
+#endif
+#if USE_RINGS
+    if(frame->payload[HDR_DRING] == RING_LOCAL)
+        frame->payload[HDR_DRING] = MY_RING;
+    frame->payload[HDR_SRING] = MY_RING;
+#endif
+#if USE_DUAL
+    frame->payload[HDR_HOPS] = 0;
+#endif
+    clearBuffer(frame->crc, 32);
+    makeCrc(frame->crc, frame->payload, FRAME_LENGTH(frame), _polynomial, GENERATE);
+#if USE_DUAL
+    // Destinations closer against the first ring take the second one
+    if(dualSend(frame))
+        return;
+#endif
+#if USE_QUEUE
+    // The arbiter hands the transmitter over, relays wait in their own queue meanwhile
+    queueLocal(frame);
+#else
+#if USE_TOKEN
+    tokenWaiting = 1;
+    while(!tokenMaySend());
+#endif
+#if USE_TDMA
+    tdmaPending = 1;
+    while(!tdmaMaySend(frame));
+#endif
+    while(((pFlag == PRIORITY_LOCK) || (pFlag == PRIORITY_SEND) || (pFlag == PRIORITY_RELAY)));
+    pFlag = PRIORITY_SEND;
+#endif
+    packFrame(tFrame, frame);
+#if USE_ARQ
+    // Gives the transmitter back to the retransmissions until the window opens again
+    while(!arqStamp(tFrame))
+    {
+        pFlag = PRIORITY_IDLE;
+        while(!arqWindowOpen());
+#if USE_QUEUE
+        queueLocal(frame);
+#else
+        while(((pFlag == PRIORITY_LOCK) || (pFlag == PRIORITY_SEND) || (pFlag == PRIORITY_RELAY)));
+        pFlag = PRIORITY_SEND;
+#endif
+        packFrame(tFrame, frame);
+    }
+#endif
+    tFlag = FLAG_SENDING_PREAMBLE;
+#if USE_TOKEN
+    tokenWaiting = 0;
+#endif
+#if USE_TDMA
+    tdmaPending = 0;
+#endif
+}
+
+void deliverFrame(const frame_t* frame)
+{
+#if USE_TDMA
+    if(TDMA_IS_SYNC(frame))
+        return;
+#endif
+#if USE_JUMBO
+    if(jumboReceive(frame))
+        return;
+#endif
+#if USE_FRAG
+    if(FRAG_IS_PART(frame))
+    {
+        fragReceive(frame);
+        return;
+    }
+#endif
+#if USE_L4
+    // Layer 4 hands the message to l4OnReceive, the frame itself goes no further
+    l4Receive(frame);
+    return;
+#endif
+    if(linkOnFrame)
+        linkOnFrame(frame);
+}
 
 /*! Data-Signal Interrupt - Packet Transmitter */
-ISR(TIMER0_COMPA_vect)
+HAL_ISR_TIMER_A
 {
+#if USE_QUEUE
+    uint8_t queueNext;
+#endif
 	if ((timerA++) > INTERRUPT_PERIOD)
 	{
+#if USE_PHY2
+        phy2TransmitBit();
+#endif
         if(((pFlag == PRIORITY_SEND) || (pFlag == PRIORITY_RELAY)))
         {
             switch(tFlag)
             {
                 // Step 1. Sending Preamble
                 case FLAG_SENDING_PREAMBLE:
-                    if(readBit(_preamble, tCounter)) 
+#if USE_JUMBO
+                    // Frames longer than a legacy frame need the jumbo format and a neighbour that takes them
+                    if(tCounter == 0)
+                    {
+                        tJumbo = (FRAME_LENGTH(tFrame) > LEGACY_PAYLOAD);
+                        if(FRAME_LENGTH(tFrame) > LINK_PAYLOAD())
+                        {
+                            stats.jumboDropped++;
+                            clearFrame(tFrame);
+                            tFlag = FLAG_IDLE;
+                            pFlag = PRIORITY_IDLE;
+                            break;
+                        }
+                    }
+#endif
+                    if(readBit((tJumbo ? _jumboPreamble : _preamble), tCounter)) 
 						SEND_DATA_ONE(); 
                     else 
 						SEND_DATA_ZERO(); 
@@ -29,11 +294,11 @@ ISR(TIMER0_COMPA_vect)
 
                 // Step 2. Sending Crc
                 case FLAG_SENDING_CRC:
-                    if(readBit(tFrame->crc, tCounter)) 
+                    if(readCodeBit(tFrame->crc, tCounter)) 
 						SEND_DATA_ONE(); 
                     else 
 						SEND_DATA_ZERO(); 
-                    if((++tCounter) >= 32)
+                    if((++tCounter) >= (4*CODE_BITS))
                     { 
                         tCounter = 0; 
                         tFlag = FLAG_SENDING_DLC; 
@@ -42,11 +307,11 @@ ISR(TIMER0_COMPA_vect)
 
                 // Step 3. Sending Size of Payload
                 case FLAG_SENDING_DLC:
-                    if(readBit(tFrame->dlc, tCounter)) 
+                    if(readCodeBit((tFrame->dlc + (DLC_SIZE - DLC_BYTES(tJumbo))), tCounter)) 
 						SEND_DATA_ONE();
                     else 
 						SEND_DATA_ZERO(); 
-                    if((++tCounter) >= 8)
+                    if((++tCounter) >= (DLC_BYTES(tJumbo)*CODE_BITS))
                     { 
                         tCounter = 0; 
                         tFlag = FLAG_SENDING_PAYLOAD; 
@@ -55,11 +320,11 @@ ISR(TIMER0_COMPA_vect)
 
                 // Step 4. Sending Payload
                 case FLAG_SENDING_PAYLOAD:
-                    if(readBit(tFrame->payload, tCounter)) 
+                    if(readCodeBit(tFrame->payload, tCounter)) 
 						SEND_DATA_ONE();
                     else 
 						SEND_DATA_ZERO(); 
-                    if((++tCounter) >= ((tFrame->dlc[0])*8))
+                    if((++tCounter) >= (FRAME_LENGTH(tFrame)*CODE_BITS))
                     {
                         if(pFlag == PRIORITY_SEND)
                         {
@@ -79,22 +344,115 @@ ISR(TIMER0_COMPA_vect)
             }
 		    timerA = 0;
         }
+#if USE_ARQ
+        // Acknowledgements and retransmissions go out whenever the transmitter is idle
+        else if((pFlag == PRIORITY_IDLE) && arqPoll(tFrame))
+        {
+            tFlag = FLAG_SENDING_PREAMBLE;
+            pFlag = PRIORITY_RELAY;
+        }
+#endif
+#if USE_TDMA
+        // The time sync of the master leads every cycle
+        else if((pFlag == PRIORITY_IDLE) && tdmaPoll(tFrame))
+        {
+            tFlag = FLAG_SENDING_PREAMBLE;
+            pFlag = PRIORITY_RELAY;
+        }
+#endif
+#if USE_AGG
+        // Aggregated frames go out once full or when their flush timer ran out
+        else if((pFlag == PRIORITY_IDLE) && aggPoll(tFrame))
+        {
+            tFlag = FLAG_SENDING_PREAMBLE;
+            pFlag = PRIORITY_RELAY;
+        }
+#endif
+#if USE_QUEUE
+        // Relayed and local frames take turns as the arbiter decides
+        else if((pFlag == PRIORITY_IDLE) && (queueNext = queuePoll(tFrame)))
+        {
+            // A frame of this node is packed and started by the waiting sendFrame
+            if((queueNext - 1) == QUEUE_LOCAL)
+                pFlag = PRIORITY_SEND;
+            else
+            {
+                tFlag = FLAG_SENDING_PREAMBLE;
+                pFlag = PRIORITY_RELAY;
+            }
+        }
+#endif
+#if USE_BRIDGE
+        // Frames from the second ring join this one whenever the transmitter is idle
+        else if((pFlag == PRIORITY_IDLE) && bridgePoll(tFrame))
+        {
+            tFlag = FLAG_SENDING_PREAMBLE;
+            pFlag = PRIORITY_RELAY;
+        }
+#endif
+#if USE_TOKEN
+        // The token moves on once this node is done or its holding time ran out
+#if USE_QUEUE
+        else if((pFlag == PRIORITY_IDLE) && tokenPoll(tFrame, queueCount[QUEUE_LOCAL]))
+#else
+        else if((pFlag == PRIORITY_IDLE) && tokenPoll(tFrame, tokenWaiting))
+#endif
+        {
+            tFlag = FLAG_SENDING_PREAMBLE;
+            pFlag = PRIORITY_RELAY;
+        }
+#endif
 	}
 }
 
 /*! Clock-Signal Interrupt */
-ISR(TIMER0_COMPB_vect)
+HAL_ISR_TIMER_B
 {
+    ticks++;
+
+    /* Receive Watchdog
+     * A frame waiting in FLAG_CHECKING_CRC is complete, so it is kept and checked on the next edge */
+    if((rFlag != FLAG_DETECTING_PREAMBLE) && (rFlag != FLAG_CHECKING_CRC))
+    {
+        if((++rSilence) > (RX_TIMEOUT_BITS*BIT_TICKS))
+            abortReceive();
+    }
+#if USE_PHY2
+    phy2Tick();
+#endif
+#if USE_TDMA
+#if USE_QUEUE
+    tdmaTick(queueCount[QUEUE_LOCAL]);
+#else
+    tdmaTick(tdmaPending);
+#endif
+#endif
+
 	if ((timerB++) > INTERRUPT_PERIOD)
 	{
 		timerB = 0;
 		PIN_CHANGE();
+#if USE_PHY2
+        PHY2_CLOCK_CHANGE();
+#endif
 	}
 }
 
 /*! Pin-Change Interrupt - Packet Receiver*/
-ISR(PCINT2_vect)
+HAL_ISR_PIN_CHANGE
 {
+#if USE_PHY2
+    // Both receivers share the interrupt - the pins that changed tell which clock moved
+    uint8_t pins = HAL_RX_PINS();
+    uint8_t changed = (pins ^ phy2Pins);
+    phy2Pins = pins;
+    if(changed & HAL_RX2_CLOCK)
+        phy2ReceiveEdge();
+    if(!(changed & HAL_RX_CLOCK))
+        return;
+#endif
+    rSilence = 0;
+
     switch(rFlag)
     {
         // Step 1. Detecting Preamble
@@ -102,16 +460,26 @@ ISR(PCINT2_vect)
             updateBit(rQueue, (rCounter%8), receiveData());
             if(checkPreamble(*rQueue, *_preamble))
             {
-                *rQueue = 0;
+                *rQueue = RX_QUEUE_RESET;
                 rCounter = 0;
+                rJumbo = 0;
                 rFlag = FLAG_RECEIVING_CRC;
             }
+#if USE_JUMBO
+            else if(checkPreamble(*rQueue, *_jumboPreamble))
+            {
+                *rQueue = RX_QUEUE_RESET;
+                rCounter = 0;
+                rJumbo = 1;
+                rFlag = FLAG_RECEIVING_CRC;
+            }
+#endif
             break;
 
         // Step 2. Receiving Crc
         case FLAG_RECEIVING_CRC:
-            updateBit(rFrame->crc, rCounter, receiveData());
-            if((++rCounter) >= 32)
+            countCode(writeCodeBit(rFrame->crc, rCounter, receiveData(), &rCode));
+            if((++rCounter) >= (4*CODE_BITS))
             {
                 rCounter = 0;
                 rFlag = FLAG_RECEIVING_DLC;
@@ -120,18 +488,26 @@ ISR(PCINT2_vect)
 
         // Step 3. Receiving Dlc
         case FLAG_RECEIVING_DLC:
-            updateBit(rFrame->dlc, rCounter, receiveData());
-            if((++rCounter) >= 8)
+            countCode(writeCodeBit((rFrame->dlc + (DLC_SIZE - DLC_BYTES(rJumbo))), rCounter, receiveData(), &rCode));
+            if((++rCounter) >= (DLC_BYTES(rJumbo)*CODE_BITS))
             {
                 rCounter = 0;
                 rFlag = FLAG_RECEIVING_PAYLOAD;
+
+                // A DLC beyond the frame buffer would overwrite the memory behind it
+                if(FRAME_LENGTH(rFrame) > FRAME_PAYLOAD)
+                {
+                    stats.rxOversize++;
+                    clearFrame(rFrame);
+                    rFlag = FLAG_DETECTING_PREAMBLE;
+                }
             }
             break;
 
         // Step 4. Receiving Payload
         case FLAG_RECEIVING_PAYLOAD:
-            updateBit(rFrame->payload, rCounter, receiveData());
-            if((++rCounter) >= ((rFrame->dlc[0])*8))
+            countCode(writeCodeBit(rFrame->payload, rCounter, receiveData(), &rCode));
+            if((++rCounter) >= (FRAME_LENGTH(rFrame)*CODE_BITS))
             {
                 rCounter = 0;
                 rFlag = FLAG_CHECKING_CRC;
@@ -140,8 +516,69 @@ ISR(PCINT2_vect)
 
         // Step 5. Checking Crc
         case FLAG_CHECKING_CRC:
-            if((makeCrc(rFrame->crc, rFrame->payload, *(rFrame->dlc), _polynomial, CHECK)))
+            // The edge that runs this step carries the first bit after the frame, e.g. of the next preamble
+            updateBit(rQueue, 0, receiveData());
+            if((makeCrc(rFrame->crc, rFrame->payload, FRAME_LENGTH(rFrame), _polynomial, CHECK)))
             {
+                // Measures the time from the last watchdog abort until the link delivered again
+                if(rRecovering)
+                {
+                    stats.rxRecovery = ticks - rAbortTick;
+                    if(stats.rxRecovery > stats.rxRecoveryMax)
+                        stats.rxRecoveryMax = stats.rxRecovery;
+                    rRecovering = 0;
+                }
+
+#if USE_ARQ
+                // Link acknowledgements and duplicates end here
+                if(!arqFilter(rFrame))
+                {
+                    clearFrame(rFrame);
+                    rFlag = FLAG_DETECTING_PREAMBLE;
+                    rCounter = 0;
+                    break;
+                }
+#endif
+
+#if USE_TOKEN
+                if(rFrame->payload[HDR_DST] == TOKEN_ID)
+                {
+                    tokenReceive(rFrame);
+                    clearFrame(rFrame);
+                    rFlag = FLAG_DETECTING_PREAMBLE;
+                    rCounter = 0;
+                    break;
+                }
+#endif
+#if USE_AGG
+                // Aggregated frames are split on every hop
+                if(rFrame->payload[HDR_DST] == AGGREGATE_ID)
+                {
+                    aggReceive(rFrame);
+                    clearFrame(rFrame);
+                    rFlag = FLAG_DETECTING_PREAMBLE;
+                    rCounter = 0;
+                    break;
+                }
+#endif
+
+#if USE_TDMA
+                tdmaSync(rFrame);
+#endif
+#if USE_DUAL
+                dualLearn(rFrame, 0);
+#endif
+#if USE_BRIDGE
+                // Frames for the other side of the bridge leave this ring here
+                if(bridgeTake(rFrame))
+                {
+                    clearFrame(rFrame);
+                    rFlag = FLAG_DETECTING_PREAMBLE;
+                    rCounter = 0;
+                    break;
+                }
+#endif
+
                 // Checking Source-Address and Destination-Address
                 switch(checkAddress(rFrame))
                 {
@@ -160,6 +597,15 @@ ISR(PCINT2_vect)
 
 					// Case 3. Broadcast Message
                     case BROADCAST:
+#if USE_DEDUP
+                        // Reinjected copies end here before any printing, copying or relaying
+                        if(dedupSeen(rFrame))
+                        {
+                            stats.dedupCaught++;
+                            clearFrame(rFrame);
+                            break;
+                        }
+#endif
                         printMsg("RECEIVE", 7); 
 						uart_changeLine();
                         printFrame(rFrame); 
@@ -169,12 +615,10 @@ ISR(PCINT2_vect)
                         printMsg("BROADCAST", 9); 
 						uart_changeLine(); 
 						uart_changeLine();
-                        *sFrame = *rFrame;
-                        pFlag = PRIORITY_LOCK;
-                        *tFrame = *rFrame;
+                        if(unpackFrame(sFrame, rFrame))
+                            deliverFrame(sFrame);
+                        relayFrame();
                         clearFrame(rFrame);
-                        tFlag = FLAG_SENDING_PREAMBLE;
-                        pFlag = PRIORITY_RELAY;
                         break;
 						
 					// Case 4. Message to me
@@ -188,23 +632,24 @@ ISR(PCINT2_vect)
                         printMsg("MESSAGE TO ME", 13);
                         uart_changeLine(); 
 						uart_changeLine();
-                        *sFrame = *rFrame;
+                        if(unpackFrame(sFrame, rFrame))
+                            deliverFrame(sFrame);
                         clearFrame(rFrame);
                         break;
 
 					// Case 5. Message to another
                     case OTHER_MSG:
-                        pFlag = PRIORITY_LOCK;
-                        *tFrame = *rFrame;
+                        relayFrame();
                         clearFrame(rFrame);
-                        tFlag = FLAG_SENDING_PREAMBLE;
-                        pFlag = PRIORITY_RELAY;
                         break;
                 }
                 rFlag = FLAG_DETECTING_PREAMBLE;
             }
             else
             {
+#if USE_ARQ
+                arqCorrupted();
+#endif
                 printMsg("CRC NO", 6);
                 uart_changeLine(); 
 				uart_changeLine();
@@ -1,24 +1,23 @@
 #pragma once
 #include <stdlib.h>
+#include "config.h"
+#include "frame.h"
 
-// Turns on LEDs : PB4 and PB5
-//#define LED_A_TOGGLE()              (PORTB ^= (1 << PB5))
-//#define LED_B_TOGGLE()              (PORTB ^= (1 << PB4))
+/// Pins of the clock and data signals - SEND_DATA_ONE, SEND_DATA_ZERO, RECEIVED_DATA and PIN_CHANGE
+#include "hal.h"
 
-/// Sends Logical 1 Data-Signal through "PB2 Pin"
-#define SEND_DATA_ONE()             (PORTB |= (1 << PB2))
-
-/// Sends Logical 0 Data-Signal through "PB2 Pin"
-#define SEND_DATA_ZERO()            (PORTB &= ~(1 << PB2))
-
-/// Receives Data-Signal through "PD4 Pin"
-#define RECEIVED_DATA()             (PIND & (1 << PD4))
+/// Interrupt Interval - per millisecond, a build for the benchmark suite sets it from the command line
+#ifndef INTERRUPT_PERIOD
+#define INTERRUPT_PERIOD            1
+#endif
 
-/// Sends Clock-Signal for Pin-Change Interrupt through "PB1 Pin"
-#define PIN_CHANGE()                (PORTB ^= (1 << PB1))
+/// Timer ticks per bit - the clock line toggles every (INTERRUPT_PERIOD+2) ticks
+#define BIT_TICKS                   (INTERRUPT_PERIOD+2)
 
-/// Interrupt Interval - per millisecond
-#define INTERRUPT_PERIOD            1
+/// Silent bit times after which the receiver abandons a partial frame
+#ifndef RX_TIMEOUT_BITS
+#define RX_TIMEOUT_BITS             16
+#endif
 
 #define PRIORITY_IDLE               50
 #define PRIORITY_RELAY              51
@@ -43,13 +42,6 @@
 #define FLAG_CHECKING_CRC           156
 #define FLAG_LAYER_3                157
 
-/// Packet Format
-typedef struct
-{
-    uint8_t crc[4];
-    uint8_t dlc[1];
-    uint8_t payload[251];
-} frame_t;
 
 const uint8_t _polynomial[5] = { 0x82, 0x60, 0x8e, 0xdb, 0x80 };
 const uint8_t _preamble[1] = { 0x7e };
@@ -64,9 +56,95 @@ volatile uint32_t rFlag = FLAG_DETECTING_PREAMBLE;
 volatile uint32_t tCounter = 0;
 volatile uint32_t rCounter = 0;
 
-uint8_t rQueue[1] = { 0 };
+/// Free-running tick counter of the clock interrupt
+volatile uint32_t ticks = 0;
+
+/// Receive watchdog - ticks since the last clock edge and the tick of the last abort
+volatile uint32_t rSilence = 0;
+volatile uint32_t rAbortTick = 0;
+volatile uint8_t rRecovering = 0;
+
+/// Shift register of the preamble detector, all 1s after every preamble and abort - both preambles start with 0,
+/// so neither shows up before eight bits of the line are in, whatever level the line idles at. The crc check
+/// after a frame shifts in the bit of its edge, so a preamble right behind a frame keeps all eight bits
+#define RX_QUEUE_RESET              0xff
+uint8_t rQueue[1] = { RX_QUEUE_RESET };
+
+/// Format of the frame on the wire - 1 for a jumbo frame with 16-bits DLC
+uint8_t tJumbo = 0;
+uint8_t rJumbo = 0;
+
+/// Hamming codeword being collected by the receiver
+uint16_t rCode = 0;
 
 frame_t* rFrame; frame_t _rFrame;
 frame_t* tFrame; frame_t _tFrame;
 frame_t* myFrame; frame_t _myFrame;
 frame_t* sFrame; frame_t _sFrame;
+
+/*! \brief      Upper layer callback for every frame delivered to this node, e.g. a host program on the POSIX backend
+  * \details    Runs inside the receive interrupt after the layers of config.h had their turn - frames that one
+  *             of them takes, e.g. every frame with USE_L4, are not passed on */
+void (*linkOnFrame)(const frame_t* frame);
+
+
+/*! \brief      Points the frame buffers at their storage and puts the transmitter and the receiver to idle,
+  *             with USE_GROUPS the address table starts out with MY_ID
+  * \return     void */
+void linkInit();
+
+
+/*! \brief      Abandons a partially received frame and returns the receiver to preamble hunting
+  * \details    Called by the receive watchdog when the upstream clock stays silent
+  *             for more than RX_TIMEOUT_BITS bit times in the middle of a frame
+  * \return     void */
+void abortReceive();
+
+
+/*! \brief      Counts the outcome of a decoded codeword in the link statistics
+  * \param      status  - Return value of writeCodeBit
+  * \return     void */
+void countCode(const uint8_t status);
+
+
+/*! \brief      Uses up one hop of a frame that is passed on with USE_TTL and counts it with USE_DUAL, the crc is generated again
+  * \param      frame   - Frame to be passed on
+  * \return     unsigned 8-bits data - 1 if it may go on, 0 if its hop limit ran out */
+uint8_t hopFrame(frame_t* frame);
+
+
+/*! \brief      Hands the received frame over to the transmitter for the next node
+  * \details    With USE_QUEUE it waits in the relay queue, else it takes the transmitter at once and a frame
+  *             still on the wire is cut off, counted in stats.txCut
+  * \return     void */
+void relayFrame();
+
+
+/*! \brief      Copies a frame for the transmitter and compresses its payload with USE_COMP
+  * \details    The crc is generated again if the payload shrank, else the frame is copied as it is
+  * \param      dst     - Transmit buffer
+  * \param      src     - Frame with a valid crc
+  * \return     void */
+void packFrame(frame_t* dst, const frame_t* src);
+
+
+/*! \brief      Copies a received frame for delivery and restores its payload with USE_COMP
+  * \param      dst     - Frame handed to deliverFrame
+  * \param      src     - Received frame
+  * \return     unsigned 8-bits data - 1 if the frame can be delivered, 0 if its payload is broken */
+uint8_t unpackFrame(frame_t* dst, const frame_t* src);
+
+
+/*! \brief      Generates the crc of a frame and hands it over to the transmitter as a local send
+  * \details    Waits until the transmitter is free - must not be called from an interrupt routine.
+  *             With USE_DUAL that holds for the second port as well: dualSend waits for the frame on it,
+  *             which only the timer interrupt clocks out, so a call with interrupts off never returns.
+  * \param      frame   - Frame to be sent, its crc is overwritten
+  * \return     void */
+void sendFrame(frame_t* frame);
+
+
+/*! \brief      Hands a frame for this node, or for everybody, over to the layers above layer 3
+  * \param      frame   - Received frame
+  * \return     void */
+void deliverFrame(const frame_t* frame);
@@ -0,0 +1,52 @@
+#pragma once
+#include "interrupt.h"
+#include "jumbo.h"
+#include "calc.c"
+#include "layer3.c"
+
+#if USE_JUMBO
+void jumboAnnounce()
+{
+    // Built in the frame of the main loop, a frame_t on the stack does not fit next to the jumbo buffers
+    clearFrame(myFrame);
+    myFrame->payload[HDR_DST] = BROADCAST_ID;
+    myFrame->payload[HDR_SRC] = MY_ID;
+    myFrame->payload[HDR_SIZE+0] = 'J';
+    myFrame->payload[HDR_SIZE+1] = 'M';
+    myFrame->payload[HDR_SIZE+2] = 'B';
+    myFrame->payload[HDR_SIZE+3] = (FRAME_PAYLOAD >> 8);
+    myFrame->payload[HDR_SIZE+4] = (FRAME_PAYLOAD & 0xff);
+    SET_LENGTH(myFrame, (HDR_SIZE + JUMBO_HELLO_SIZE));
+    sendFrame(myFrame);
+
+    jumboSent = ticks;
+    jumboStarted = 1;
+}
+
+uint8_t jumboReceive(const frame_t* frame)
+{
+    if((FRAME_LENGTH(frame) != (HDR_SIZE + JUMBO_HELLO_SIZE)) || (frame->payload[HDR_DST] != BROADCAST_ID))
+        return 0x00;
+    if((frame->payload[HDR_SIZE+0] != 'J') || (frame->payload[HDR_SIZE+1] != 'M') || (frame->payload[HDR_SIZE+2] != 'B'))
+        return 0x00;
+
+    if(frame->payload[HDR_SRC] == NEXT_ID)
+    {
+        uint16_t size = ((frame->payload[HDR_SIZE+3] << 8) | frame->payload[HDR_SIZE+4]);
+        jumboNext = (size < FRAME_PAYLOAD) ? size : FRAME_PAYLOAD;
+        if(jumboNext < LEGACY_PAYLOAD)
+            jumboNext = LEGACY_PAYLOAD;
+        jumboHeard = ticks;
+    }
+    return 0x01;
+}
+
+void jumboPoll()
+{
+    if((!jumboStarted) || ((ticks - jumboSent) > (JUMBO_HELLO_BITS*BIT_TICKS)))
+        jumboAnnounce();
+
+    if((jumboNext > LEGACY_PAYLOAD) && ((ticks - jumboHeard) > (JUMBO_EXPIRY_BITS*BIT_TICKS)))
+        jumboNext = LEGACY_PAYLOAD;
+}
+#endif
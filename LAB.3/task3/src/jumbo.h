@@ -0,0 +1,52 @@
+#pragma once
+#include "config.h"
+
+/*! Preamble of a jumbo frame, followed by crc, a 16-bits DLC and the payload.
+ * Like the legacy 0x7e it ends in 0, so no run of idle 1 bits builds it in the receive register, and neither
+ * shows up in the bits that lead into the other one */
+#define JUMBO_PREAMBLE      0x7c
+
+/// Announcement - broadcast of "JMB" and the largest payload the node takes, big endian
+#define JUMBO_HELLO_SIZE    5
+
+/// Bit times between two announcements, and after which a silent neighbour counts as legacy again
+#define JUMBO_HELLO_BITS    (RING_SIZE * 2040UL * 8)
+#define JUMBO_EXPIRY_BITS   (3 * JUMBO_HELLO_BITS)
+
+/// Largest payload the outgoing link takes
+#if USE_JUMBO
+#define LINK_PAYLOAD()      (jumboNext)
+#else
+#define LINK_PAYLOAD()      (FRAME_PAYLOAD)
+#endif
+
+/// Bytes of the DLC on the wire
+#define DLC_BYTES(jumbo)    ((jumbo) ? 2 : 1)
+
+const uint8_t _jumboPreamble[1] = { JUMBO_PREAMBLE };
+
+#if USE_JUMBO
+/// Largest payload of the downstream neighbour, LEGACY_PAYLOAD until it announces more
+uint16_t jumboNext = LEGACY_PAYLOAD;
+uint32_t jumboHeard = 0;
+uint32_t jumboSent = 0;
+uint8_t jumboStarted = 0;
+#endif
+
+/*! \brief      Broadcasts the largest payload this node takes
+  * \details    Waits for the transmitter like sendFrame - must not be called from an interrupt routine.
+  *             The announcement is built in myFrame, which the console fills again before every message.
+  * \return     void */
+void jumboAnnounce();
+
+
+/*! \brief      Learns the jumbo size of the downstream neighbour (NEXT_ID) from its announcement
+  * \param      frame   - Frame for this node or for everybody
+  * \return     unsigned 8-bits data - 1 if the frame was an announcement, else 0 */
+uint8_t jumboReceive(const frame_t* frame);
+
+
+/*! \brief      Repeats the announcement and forgets a neighbour that stopped announcing
+  * \details    Called from the main loop
+  * \return     void */
+void jumboPoll();
@@ -1,9 +1,81 @@
 #pragma once
 #include "layer3.h"
+#include "token.h"
 #include "calc.c"
 
+#if USE_RINGS
+/// Frames that started on or are bound for another ring - the node ID alone says nothing there
+uint8_t checkRing(const frame_t* frame)
+{
+    uint8_t dst = frame->payload[HDR_DST];
+
+    if(!IS_MY_RING(frame->payload[HDR_DRING]))
+    {
+        if(IS_MY_RING(frame->payload[HDR_SRING]) && (frame->payload[HDR_SRC] == MY_ID))
+            return RETURNED;
+        return OTHER_MSG;
+    }
+    if(dst == BROADCAST_ID)
+        return BROADCAST;
+#if USE_GROUPS
+    if(ADDR_MEMBER(dst))
+        return ((dst >= GROUP_FIRST) && (dst < TOKEN_ID)) ? BROADCAST : MY_MSG;
+#else
+    if(dst == MY_ID)
+        return MY_MSG;
+#endif
+    return OTHER_MSG;
+}
+#endif
+
+#if USE_GROUPS
+void addrInit()
+{
+    for(uint8_t i=0; i<32; i++)
+        addrTable[i] = 0;
+    addrJoin(MY_ID);
+}
+
+void addrJoin(const uint8_t id)
+{
+    if((id == BROADCAST_ID) || (id >= TOKEN_ID))
+        return;
+    addrTable[(id >> 3)] |= (1 << (id & 0x07));
+}
+
+void addrLeave(const uint8_t id)
+{
+    if(id == MY_ID)
+        return;
+    addrTable[(id >> 3)] &= ~(1 << (id & 0x07));
+}
+
+uint8_t checkAddress(const frame_t* frame)
+{
+#if USE_RINGS
+    if(!IS_MY_RING(frame->payload[HDR_DRING]) || !IS_MY_RING(frame->payload[HDR_SRING]))
+        return checkRing(frame);
+#endif
+    uint8_t dst = frame->payload[0];
+    uint8_t src = frame->payload[1];
+    uint8_t group = ((dst == BROADCAST_ID) || ((dst >= GROUP_FIRST) && (dst < TOKEN_ID)));
+
+    // Frames of this node come back from any of its IDs
+    if(ADDR_MEMBER(src))
+        return group ? MY_BROADCAST : RETURNED;
+    if(dst == BROADCAST_ID)
+        return BROADCAST;
+    if(!ADDR_MEMBER(dst))
+        return OTHER_MSG;
+    return group ? BROADCAST : MY_MSG;
+}
+#else
 uint8_t checkAddress(const frame_t* frame)
 {
+#if USE_RINGS
+    if(!IS_MY_RING(frame->payload[HDR_DRING]) || !IS_MY_RING(frame->payload[HDR_SRING]))
+        return checkRing(frame);
+#endif
     uint8_t result = 0;
     uint8_t dst = frame->payload[0];
     uint8_t src = frame->payload[1];
@@ -27,3 +99,4 @@ uint8_t checkAddress(const frame_t* frame)
 
     return result;
 }
+#endif
@@ -1,9 +1,68 @@
 #pragma once
+#include "config.h"
 
 #define BROADCAST_ID    0x00
+
+/// Addresses of this node and its neighbours - a build for the ring emulator sets them from the command line
+#ifndef MY_ID
 #define MY_ID           0x0f
+#endif
+#ifndef NEXT_ID
 #define NEXT_ID         0x04
+#endif
+#ifndef OTHER_ID
 #define OTHER_ID        0x09
+#endif
+
+/// Number of nodes on the ring
+#ifndef RING_SIZE
+#define RING_SIZE       8
+#endif
+
+/// Link-local destination of an aggregated frame - the next node always splits it up
+#define AGGREGATE_ID    0xff
+
+/// Upstream neighbour - receives the link acknowledgements of USE_ARQ
+#ifndef PREV_ID
+#define PREV_ID         0x01
+#endif
+
+/// Ring of this node - ring 0 in a header stands for the ring of the sender
+#ifndef MY_RING
+#define MY_RING         0x01
+#endif
+#define RING_LOCAL      0x00
+#define IS_MY_RING(r)   (((r) == RING_LOCAL) || ((r) == MY_RING))
+
+/// Destinations from here up to TOKEN_ID are multicast groups - delivered to members and relayed like broadcasts
+#define GROUP_FIRST     0xe0
+
+#if USE_GROUPS
+/// Membership bitmap - one bit per address, set for the own IDs and the subscribed groups
+uint8_t addrTable[32];
+#define ADDR_MEMBER(id) (addrTable[((id) >> 3)] & (1 << ((id) & 0x07)))
+#endif
+
+/// Relays a frame may still take - a frame starting with the ring size reaches every node and its source again
+#define TTL_DEFAULT     RING_SIZE
+
+#if USE_TTL
+/// Hop limit of the frames sent by this node, unless the frame brings its own
+uint8_t ttlStart = TTL_DEFAULT;
+#endif
+
+/// Payload header - addresses first, then one byte per optional feature of config.h
+#define HDR_DST         0
+#define HDR_SRC         1
+#define HDR_LINK        2
+#define HDR_TTL         (HDR_LINK + USE_ARQ)
+#define HDR_SEQ         (HDR_TTL + USE_TTL)
+#define HDR_DRING       (HDR_SEQ + USE_DEDUP)
+#define HDR_SRING       (HDR_DRING + 1)
+#define HDR_HOPS        (HDR_DRING + (2*USE_RINGS))
+#define HDR_FRAG        (HDR_HOPS + USE_DUAL)
+#define HDR_COMP        (HDR_FRAG + (3*USE_FRAG))
+#define HDR_SIZE        (HDR_COMP + USE_COMP)
 
 #define RETURNED        1
 #define MY_BROADCAST    2
@@ -25,3 +84,20 @@
   * \details Case 5. OTHER_MSG
   * : Received a message that someone sent to another */
 uint8_t checkAddress(const frame_t* frame);
+
+
+/*! \brief      Empties the address table and enters MY_ID
+  * \return     void */
+void addrInit();
+
+
+/*! \brief      Adds an own address or a multicast group to the address table
+  * \param      id      - Unicast ID or group from GROUP_FIRST on
+  * \return     void */
+void addrJoin(const uint8_t id);
+
+
+/*! \brief      Removes an address or a multicast group from the address table, MY_ID stays
+  * \param      id      - Unicast ID or group
+  * \return     void */
+void addrLeave(const uint8_t id);
@@ -3,84 +3,158 @@
   * \author     Hansang Lee
   * \date       8 July 2019 */
 
-#include "init.c"
 #include "interrupt.c"
 
+#if USE_FRAG
+/// Reassembly buffer of the console
+uint8_t _message[FRAG_MESSAGE_SIZE];
+#endif
+
 int main()
 {
-    /// Initializes Frame Packets
-    rFrame = &_rFrame;
-    tFrame = &_tFrame;
-    myFrame = &_myFrame;
-    sFrame = &_sFrame;
+    /// Initializes Frame Packets and flag variables
+    linkInit();
 
-    /// Initializes flag variables
-    tFlag = FLAG_IDLE;
-    rFlag = FLAG_DETECTING_PREAMBLE;
-    pFlag = PRIORITY_IDLE;
+#if USE_FRAG
+    /// Reassembles long messages into one buffer and prints them
+    fragProvide(_message, sizeof(_message));
+    fragOnMessage = fragPrintMessage;
+#endif
 
-    /// Initializes Packets
-    clearFrame(tFrame);
-    clearFrame(myFrame);
-    clearFrame(rFrame);
+#if USE_AGG
+    /// Prints every aggregated record for this node
+    aggOnMessage = aggPrintMessage;
+#endif
 
-    /// Pre-defined Packet without Destination-Address
-    myFrame->dlc[0]     = 0x06;
-    myFrame->payload[1] = 0x0f;
-    myFrame->payload[2] = 0x74;
-    myFrame->payload[3] = 0x65;
-    myFrame->payload[4] = 0x73;
-    myFrame->payload[5] = 0x74;
+#if USE_L4
+    /// Prints every layer 4 message and timeout
+    l4OnReceive = l4PrintMessage;
+    l4OnTimeout = l4PrintTimeout;
+#endif
 
     /// Initializes Interrupts
 	io_setup();
-	cli();
+	HAL_IRQ_OFF();
 	uart_init(MYUBRR);
 	interrupt_setup();
 	pin_change_setup();
-	sei();
+#if USE_FLOW
+    /// Ready lines to the upstream and from the downstream node
+    flowSetup();
+#endif
+#if USE_BRIDGE
+    /// Second port towards BRIDGE_RING
+    bridgeInit();
+    phy2OnFrame = bridgeOnFrame;
+    phy2Setup();
+#endif
+#if USE_DUAL
+    /// Second port against the first ring
+    phy2OnFrame = dualOnFrame;
+    phy2Setup();
+#endif
+	HAL_IRQ_ON();
 
     /// User-Input
     uint8_t input = 0;
     for(;;)
 	{
-        /// Sets Input Mode by pressing alphabet 'a'
-        if(uart_receive() == 'a')
+#if USE_L4
+        /// Acknowledges and retransmits layer 4 segments
+        l4Poll();
+#endif
+#if USE_FRAG
+        /// Releases reassembly buffers of incomplete messages
+        fragPoll();
+#endif
+#if USE_JUMBO
+        /// Announces the jumbo size to the upstream neighbour
+        jumboPoll();
+#endif
+        if(!uart_available())
         {
-            myFrame->payload[0] = 0x00;
-            printMsg("DESTINATION : ", 14);
-            
-            while(1)
-            {
-                input = uart_receive();
-                uart_transmit((char)input);
+            HAL_DELAY_MS(INTERRUPT_PERIOD);
+            continue;
+        }
+        input = uart_receive();
+
+        /// Prints the link statistics by pressing alphabet 's'
+        if(input == 's')
+        {
+            printStats();
+            uart_changeLine();
+        }
+
+#if USE_GROUPS
+        /// Joins an address or multicast group by pressing alphabet 'j'
+        else if(input == 'j')
+        {
+            addrJoin(readNumber("JOIN : ", 7));
+            uart_changeLine();
+        }
 
-                /// Finalizes the Destination-Address through user-input by pressing 'Enter'
-                if(input == 0x0d) 
-                    break;
+        /// Leaves an address or multicast group by pressing alphabet 'l'
+        else if(input == 'l')
+        {
+            addrLeave(readNumber("LEAVE : ", 8));
+            uart_changeLine();
+        }
+#endif
 
-                else 
-                {
-                    /// Initializes the written numbers by pressing 'Backspace'
-                    if((input == 0x7f) || (input == 0x08))
-					{
-						myFrame->payload[0] = 0x00;
-						uart_transmit('\r'); printMsg("DESTINATION :       ", 20);
-						uart_transmit('\r'); printMsg("DESTINATION : ", 14);
-					}
-                    else
-                    {
-						myFrame->payload[0] = ((myFrame->payload[0] * 10) + (((uint8_t)input)-48));
-                    }
-                }
+#if USE_FRAG
+        /// Sends a message as long as the reassembly buffer in fragments by pressing alphabet 'f' - it is written
+        /// into that buffer, so no message of another node is reassembled meanwhile
+        else if(input == 'f')
+        {
+            uint8_t dst = readNumber("DESTINATION : ", 14);
+            uart_changeLine();
+            if(fragWithdraw(_message))
+            {
+                for(uint16_t i=0; i<sizeof(_message); i++)
+                    _message[i] = ('a' + (i % 26));
+                fragSend(dst, _message, sizeof(_message));
+                fragProvide(_message, sizeof(_message));
+            }
+            else
+            {
+                printMsg("BUSY", 4);
+                uart_changeLine();
             }
-			clearBuffer(myFrame->crc, 32);
-			makeCrc(myFrame->crc, myFrame->payload, myFrame->dlc[0], _polynomial, GENERATE);
-			while(((pFlag == PRIORITY_LOCK) || (pFlag == PRIORITY_SEND) || (pFlag == PRIORITY_RELAY)));
-			pFlag = PRIORITY_SEND;
-			*tFrame = *myFrame;
-			tFlag = FLAG_SENDING_PREAMBLE;
+        }
+#endif
+
+        /// Sets Input Mode by pressing alphabet 'a'
+        else if(input == 'a')
+        {
+            /// Pre-defined Packet without Destination-Address, filled again since jumboAnnounce borrows myFrame
+            clearFrame(myFrame);
+            SET_LENGTH(myFrame, (HDR_SIZE + 4));
+            myFrame->payload[HDR_SRC] = MY_ID;
+            myFrame->payload[HDR_SIZE+0] = 0x74;
+            myFrame->payload[HDR_SIZE+1] = 0x65;
+            myFrame->payload[HDR_SIZE+2] = 0x73;
+            myFrame->payload[HDR_SIZE+3] = 0x74;
+
+            /// Finalizes the Destination-Address through user-input by pressing 'Enter'
+            myFrame->payload[HDR_DST] = readNumber("DESTINATION : ", 14);
+#if USE_RINGS
+            uart_changeLine();
+            myFrame->payload[HDR_DRING] = readNumber("RING : ", 7);
+#endif
+#if USE_L4
+			if(!l4Send(myFrame->payload[HDR_DST], ((L4_PORT_CONSOLE << 4) | L4_PORT_CONSOLE), (const uint8_t*)"test", 4, 0))
+			{
+				printMsg("BUSY", 4);
+				uart_changeLine();
+			}
+#elif USE_AGG
+			aggSend(myFrame->payload[HDR_DST], (const uint8_t*)"test", 4);
+#elif USE_FRAG
+			fragSend(myFrame->payload[HDR_DST], (const uint8_t*)"test", 4);
+#else
+			sendFrame(myFrame);
+#endif
 		}
-        _delay_ms(INTERRUPT_PERIOD);
+        HAL_DELAY_MS(INTERRUPT_PERIOD);
 	}
 }
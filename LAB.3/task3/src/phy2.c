@@ -0,0 +1,148 @@
+#pragma once
+#include "interrupt.h"
+#include "phy2.h"
+#include "calc.c"
+#include "stats.c"
+
+#if USE_PHY2
+void phy2Setup()
+{
+    PHY2_SETUP_PINS();
+    phy2Pins = HAL_RX_PINS();
+}
+
+frame_t* phy2Claim()
+{
+    uint8_t sreg;
+    frame_t* result = 0;
+    HAL_IRQ_SAVE(sreg);
+    if(phy2TxFlag == FLAG_IDLE)
+    {
+        phy2TxFlag = FLAG_WAITING;
+        result = &phy2Tx;
+    }
+    HAL_IRQ_RESTORE(sreg);
+    return result;
+}
+
+uint8_t phy2Start()
+{
+    if(FRAME_LENGTH(&phy2Tx) > LEGACY_PAYLOAD)
+    {
+        phy2TxFlag = FLAG_IDLE;
+        return 0x00;
+    }
+    phy2TxCounter = 0;
+    phy2TxFlag = FLAG_SENDING_PREAMBLE;
+    return 0x01;
+}
+
+uint8_t phy2Send(const frame_t* frame)
+{
+    frame_t* buffer = phy2Claim();
+    if(!buffer)
+        return 0x00;
+    *buffer = *frame;
+    return phy2Start();
+}
+
+void phy2TransmitBit()
+{
+    if((phy2TxFlag == FLAG_IDLE) || (phy2TxFlag == FLAG_WAITING))
+        return;
+
+    // Preamble, crc, the last byte of the DLC and the payload as one bit string
+    uint16_t pos = phy2TxCounter;
+    uint8_t data;
+    if(pos < 8)
+        data = readBit(_preamble, pos);
+    else if(pos < 40)
+        data = readBit(phy2Tx.crc, (pos - 8));
+    else if(pos < PHY2_HEADER_BITS)
+        data = readBit(&phy2Tx.dlc[(DLC_SIZE-1)], (pos - 40));
+    else
+        data = readBit(phy2Tx.payload, (pos - PHY2_HEADER_BITS));
+
+    if(data)
+        PHY2_DATA_ONE();
+    else
+        PHY2_DATA_ZERO();
+
+    if((++phy2TxCounter) >= (PHY2_HEADER_BITS + (FRAME_LENGTH(&phy2Tx)*8)))
+        phy2TxFlag = FLAG_IDLE;
+}
+
+void phy2ReceiveEdge()
+{
+    uint8_t data = PHY2_RECEIVED_DATA();
+    phy2Silence = 0;
+
+    switch(phy2RxFlag)
+    {
+        case FLAG_DETECTING_PREAMBLE:
+            phy2RxQueue = ((phy2RxQueue << 1) | data);
+            if(checkPreamble(phy2RxQueue, *_preamble))
+            {
+                clearFrame(&phy2Rx);
+                phy2RxQueue = 0;
+                phy2RxCounter = 0;
+                phy2RxFlag = FLAG_RECEIVING_PAYLOAD;
+            }
+            break;
+
+        case FLAG_RECEIVING_PAYLOAD:
+        {
+            // The preamble is not stored, so the crc starts at bit 0
+            uint16_t pos = phy2RxCounter;
+            if(pos < 32)
+                updateBit(phy2Rx.crc, pos, data);
+            else if(pos < 40)
+                updateBit(&phy2Rx.dlc[(DLC_SIZE-1)], (pos - 32), data);
+            else
+                updateBit(phy2Rx.payload, (pos - 40), data);
+
+            if(((++phy2RxCounter) == 40) && (FRAME_LENGTH(&phy2Rx) > LEGACY_PAYLOAD))
+            {
+                stats.rxOversize++;
+                phy2RxFlag = FLAG_DETECTING_PREAMBLE;
+                break;
+            }
+            if((phy2RxCounter >= 40) && (phy2RxCounter >= (40 + (FRAME_LENGTH(&phy2Rx)*8))))
+            {
+                if(makeCrc(phy2Rx.crc, phy2Rx.payload, FRAME_LENGTH(&phy2Rx), _polynomial, CHECK))
+                {
+                    phy2RxFlag = FLAG_LAYER_3;
+                    phy2OnFrame(&phy2Rx);
+                }
+                else
+                {
+                    stats.phy2CrcErrors++;
+                    phy2RxFlag = FLAG_DETECTING_PREAMBLE;
+                }
+            }
+            break;
+        }
+
+        // Frame still with the upper layer
+        default:
+            break;
+    }
+}
+
+void phy2Release()
+{
+    phy2RxQueue = 0;
+    phy2RxFlag = FLAG_DETECTING_PREAMBLE;
+}
+
+void phy2Tick()
+{
+    if(phy2RxFlag != FLAG_RECEIVING_PAYLOAD)
+        return;
+    if((++phy2Silence) > (RX_TIMEOUT_BITS*BIT_TICKS))
+    {
+        stats.rxTimeouts++;
+        phy2Release();
+    }
+}
+#endif
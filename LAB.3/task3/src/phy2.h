@@ -0,0 +1,75 @@
+#pragma once
+#include "config.h"
+#include "hal.h"
+
+/* Second Port
+ * A plain RaspNet link on a second pin pair, driven by the same timer as the first one.
+ * It always speaks the legacy frame - no FEC, no jumbo DLC and no link acknowledgements. */
+
+/* Pins
+ * PHY2_CLOCK_CHANGE, PHY2_DATA_ONE, PHY2_DATA_ZERO and PHY2_RECEIVED_DATA come from the backend of hal.h */
+
+/// Bits of preamble, crc and dlc in front of the payload
+#define PHY2_HEADER_BITS            (8 + 32 + 8)
+
+#if USE_PHY2
+/// Transmit and receive buffers - 2 more frame_t of RAM
+frame_t phy2Tx;
+frame_t phy2Rx;
+
+volatile uint8_t phy2TxFlag = FLAG_IDLE;
+volatile uint16_t phy2TxCounter = 0;
+
+volatile uint8_t phy2RxFlag = FLAG_DETECTING_PREAMBLE;
+volatile uint16_t phy2RxCounter = 0;
+volatile uint8_t phy2RxQueue = 0;
+volatile uint32_t phy2Silence = 0;
+
+/// Last level of the receive pins, tells the pin-change interrupt which clock moved
+volatile uint8_t phy2Pins = 0;
+#endif
+
+/*! \brief      Upper layer callback for every intact frame of the second port
+  * \details    Runs inside the receive interrupt, the receiver stays stopped until phy2Release is called */
+void (*phy2OnFrame)(frame_t* frame);
+
+
+/*! \brief      Setup for the pins and the pin-change interrupt of the second port
+  * \return     void */
+void phy2Setup();
+
+
+/*! \brief      Reserves the idle transmitter of the second port, which is then filled in place
+  * \return     frame_t* - Transmit buffer, or 0 if the transmitter is busy */
+frame_t* phy2Claim();
+
+
+/*! \brief      Starts sending the claimed transmit buffer
+  * \return     unsigned 8-bits data - 1 if started, 0 if the frame is too long for the second port */
+uint8_t phy2Start();
+
+
+/*! \brief      Hands a frame with a valid crc over to the transmitter of the second port
+  * \param      frame   - Frame to be sent, at most LEGACY_PAYLOAD bytes
+  * \return     unsigned 8-bits data - 1 if taken, 0 if the transmitter is busy or the frame too long */
+uint8_t phy2Send(const frame_t* frame);
+
+
+/*! \brief      Sends the next bit of the second port, called at the bit rate of the first one
+  * \return     void */
+void phy2TransmitBit();
+
+
+/*! \brief      Takes one bit from the second port on a clock edge
+  * \return     void */
+void phy2ReceiveEdge();
+
+
+/*! \brief      Restarts the receiver of the second port once the upper layer is done with the frame
+  * \return     void */
+void phy2Release();
+
+
+/*! \brief      Receive watchdog of the second port, called on every timer tick
+  * \return     void */
+void phy2Tick();
@@ -0,0 +1,165 @@
+#pragma once
+#include "interrupt.h"
+#include "queue.h"
+#include "calc.c"
+#include "stats.c"
+#include "arq.c"
+#include "flow.c"
+#include "token.c"
+#include "tdma.c"
+
+#if USE_QUEUE
+/// Bytes a frame takes in the relay queue
+#define QUEUE_SIZE(frame)   (4 + DLC_SIZE + FRAME_LENGTH(frame))
+
+/// Relayed frame of entry "i", only the bytes up to its length are valid
+static frame_t* queueEntry(const uint8_t i)
+{
+    return (frame_t*)&queuePool[queueStart[i]];
+}
+
+/// Oldest frame of a class
+static const frame_t* queueFront(const uint8_t c)
+{
+    return (c == QUEUE_RELAY) ? queueEntry(queueHead) : queueWaiting;
+}
+
+/// Copies the crc, the length and the payload in use
+static void queueCopy(frame_t* dst, const frame_t* src)
+{
+    for(uint8_t i=0; i<4; i++)
+        dst->crc[i] = src->crc[i];
+    for(uint8_t i=0; i<DLC_SIZE; i++)
+        dst->dlc[i] = src->dlc[i];
+    for(uint16_t i=0; i<FRAME_LENGTH(src); i++)
+        dst->payload[i] = src->payload[i];
+}
+
+uint8_t queueRelay(const frame_t* frame)
+{
+    uint8_t count = queueCount[QUEUE_RELAY];
+    uint16_t size = QUEUE_SIZE(frame);
+    uint16_t start = 0;
+    if(count >= QUEUE_ENTRIES)
+        return 0x00;
+    if(count)
+    {
+        // Behind the newest frame, or in front of the oldest one once the pool wrapped
+        uint8_t last = ((queueHead + count - 1) % QUEUE_ENTRIES);
+        uint16_t front = queueStart[queueHead];
+        uint16_t back = (queueStart[last] + QUEUE_SIZE(queueEntry(last)));
+        if((back > front) && ((back + size) <= QUEUE_RELAY_BYTES))
+            start = back;
+        else if((back > front) && (size <= front))
+            start = 0;
+        else if((back <= front) && ((back + size) <= front))
+            start = back;
+        else
+            return 0x00;
+    }
+    else if(size > QUEUE_RELAY_BYTES)
+        return 0x00;
+
+    uint8_t i = ((queueHead + count) % QUEUE_ENTRIES);
+    queueStart[i] = start;
+    queueSince[i] = ticks;
+    queueCopy(queueEntry(i), frame);
+    queueCount[QUEUE_RELAY]++;
+#if USE_FLOW
+    flowUpdate(queueCount[QUEUE_RELAY]);
+#endif
+    return 0x01;
+}
+
+void queueLocal(const frame_t* frame)
+{
+    HAL_IRQ_OFF();
+    queueWaiting = frame;
+    queueWaitingSince = ticks;
+    queueCount[QUEUE_LOCAL] = 1;
+    HAL_IRQ_ON();
+    while(queueCount[QUEUE_LOCAL]);
+}
+
+/// Class of the next frame, or 2 if both are empty
+static uint8_t queuePick()
+{
+    if(!queueCount[QUEUE_RELAY] && !queueCount[QUEUE_LOCAL])
+        return 2;
+#if USE_TOKEN
+    // Frames of this node wait for the token
+    if(queueCount[QUEUE_LOCAL] && !tokenMaySend())
+        return queueCount[QUEUE_RELAY] ? QUEUE_RELAY : 2;
+#endif
+#if USE_TDMA
+    // Frames of this node wait for its slot
+    if(queueCount[QUEUE_LOCAL] && !tdmaMaySend(queueWaiting))
+        return queueCount[QUEUE_RELAY] ? QUEUE_RELAY : 2;
+#endif
+#if USE_FLOW
+    // Congestion here or downstream - only the ring traffic moves on
+    if(queueCount[QUEUE_LOCAL] && !flowMayInject(queueCount[QUEUE_RELAY]))
+        return queueCount[QUEUE_RELAY] ? QUEUE_RELAY : 2;
+#endif
+    if(queueArbiter == QUEUE_STRICT_RELAY)
+        return queueCount[QUEUE_RELAY] ? QUEUE_RELAY : QUEUE_LOCAL;
+    if(queueArbiter == QUEUE_STRICT_LOCAL)
+        return queueCount[QUEUE_LOCAL] ? QUEUE_LOCAL : QUEUE_RELAY;
+
+    // Deficit round-robin - a class sends while its deficit covers the frame, else the turn moves on
+    for(;;)
+    {
+        uint8_t c = queueTurn;
+        if(!queueCount[c])
+            queueDeficit[c] = 0;
+        else if(FRAME_LENGTH(queueFront(c)) <= queueDeficit[c])
+            return c;
+        queueTurn ^= 1;
+        queueDeficit[queueTurn] += queueQuantum[queueTurn];
+    }
+}
+
+uint8_t queuePoll(frame_t* frame)
+{
+    uint8_t c = queuePick();
+    if(c > QUEUE_LOCAL)
+        return 0x00;
+
+    // Frames of this node stay with sendFrame, which packs them into the transmit buffer itself
+    uint32_t wait = ticks - queueWaitingSince;
+    if(c == QUEUE_RELAY)
+    {
+        queueCopy(frame, queueEntry(queueHead));
+#if USE_ARQ
+        if(!arqStamp(frame))
+            return 0x00;
+#endif
+        wait = ticks - queueSince[queueHead];
+    }
+    if(queueArbiter == QUEUE_DRR)
+        queueDeficit[c] -= FRAME_LENGTH(queueFront(c));
+    if(c == QUEUE_RELAY)
+        queueHead = ((queueHead + 1) % QUEUE_ENTRIES);
+    queueCount[c]--;
+#if USE_FLOW
+    if(c == QUEUE_RELAY)
+        flowUpdate(queueCount[c]);
+#endif
+
+    if(c == QUEUE_RELAY)
+    {
+        stats.queueRelayFrames++;
+        stats.queueRelayWait += wait;
+        if(wait > stats.queueRelayWaitMax)
+            stats.queueRelayWaitMax = wait;
+    }
+    else
+    {
+        stats.queueLocalFrames++;
+        stats.queueLocalWait += wait;
+        if(wait > stats.queueLocalWaitMax)
+            stats.queueLocalWaitMax = wait;
+    }
+    return (c + 1);
+}
+#endif
@@ -0,0 +1,68 @@
+#pragma once
+#include "config.h"
+
+/// Traffic classes of the transmitter
+#define QUEUE_RELAY         0
+#define QUEUE_LOCAL         1
+
+/// Bytes of a full frame - the crc, the length field and the payload
+#define QUEUE_FRAME_MAX     (4 + DLC_SIZE + FRAME_PAYLOAD)
+
+/*! Relayed frames are packed back to back with only the payload in use, so short frames share the room of a full one.
+ * Frames of this node are not copied at all - sendFrame waits with its frame until the arbiter takes it.
+ * USE_FLOW adds no room, its ready line pauses upstream as soon as one frame waits */
+#ifndef QUEUE_RELAY_BYTES
+#define QUEUE_RELAY_BYTES   QUEUE_FRAME_MAX
+#endif
+
+/// Relayed frames waiting at most, whatever their size
+#ifndef QUEUE_ENTRIES
+#define QUEUE_ENTRIES       8
+#endif
+
+/// Arbiters - strict priority for one class, or deficit round-robin by payload bytes
+#define QUEUE_STRICT_RELAY  0
+#define QUEUE_STRICT_LOCAL  1
+#define QUEUE_DRR           2
+
+/// Arbiter after start-up, and the bytes each class may send per round of QUEUE_DRR
+#define QUEUE_ARBITER       QUEUE_DRR
+#define QUEUE_QUANTUM       64
+
+#if USE_QUEUE
+uint8_t queuePool[QUEUE_RELAY_BYTES];
+uint16_t queueStart[QUEUE_ENTRIES];
+uint32_t queueSince[QUEUE_ENTRIES];
+volatile uint8_t queueHead = 0;
+volatile uint8_t queueCount[2] = { 0, 0 };
+
+/// Frame of this node waiting in sendFrame, and since when
+const frame_t* volatile queueWaiting = 0;
+uint32_t queueWaitingSince;
+
+/// Arbiter in use, the bytes per round of every class and the state of the round-robin
+uint8_t queueArbiter = QUEUE_ARBITER;
+uint16_t queueQuantum[2] = { QUEUE_QUANTUM, QUEUE_QUANTUM };
+int16_t queueDeficit[2] = { 0, 0 };
+uint8_t queueTurn = QUEUE_RELAY;
+#endif
+
+/*! \brief      Queues a received frame for the next node
+  * \param      frame   - Frame with a valid crc
+  * \return     unsigned 8-bits data - 1 if queued, 0 if the relay queue has no room for it */
+uint8_t queueRelay(const frame_t* frame);
+
+
+/*! \brief      Queues a frame of this node and waits until the arbiter hands the transmitter over
+  * \details    Returns with pFlag at PRIORITY_SEND, the caller packs the frame into tFrame and starts the transmitter.
+  *             Must not be called from an interrupt routine
+  * \param      frame   - Frame with a valid crc, left untouched until the call returns
+  * \return     void */
+void queueLocal(const frame_t* frame);
+
+
+/*! \brief      Lets the arbiter pick the next frame for the idle transmitter
+  * \param      frame   - Transmit buffer
+  * \return     unsigned 8-bits data - QUEUE_RELAY + 1 if a relayed frame is in the buffer, QUEUE_LOCAL + 1 if sendFrame
+  *             may take the transmitter, 0 if nothing is sent */
+uint8_t queuePoll(frame_t* frame);
@@ -0,0 +1,122 @@
+#pragma once
+#include "stats.h"
+#include "jumbo.h"
+#include "calc.c"
+
+/// One line of the statistics - a label of 13 characters in flash and its counter
+void printCounter(const char* name, const uint32_t value)
+{
+    printFlash(name, 13);
+    printNumber(value);
+    uart_changeLine();
+}
+
+void printStats()
+{
+    printCounter(HAL_FLASH_STR("RX TIMEOUT   "), stats.rxTimeouts);
+    printFlash(HAL_FLASH_STR("RX RECOVERY  "), 13);
+    printNumber(stats.rxRecovery);
+    printFlash(HAL_FLASH_STR(" / "), 3);
+    printNumber(stats.rxRecoveryMax);
+    uart_changeLine();
+    printCounter(HAL_FLASH_STR("RX OVERSIZE  "), stats.rxOversize);
+#if !USE_QUEUE
+    printCounter(HAL_FLASH_STR("TX CUT       "), stats.txCut);
+#endif
+
+#if USE_FEC
+    printCounter(HAL_FLASH_STR("FEC FIXED    "), stats.fecCorrected);
+    printCounter(HAL_FLASH_STR("FEC FAILED   "), stats.fecFailed);
+#endif
+
+#if USE_ARQ
+    printCounter(HAL_FLASH_STR("ARQ RESENT   "), stats.arqRetransmits);
+    printCounter(HAL_FLASH_STR("ARQ NACK     "), stats.arqNacks);
+    printCounter(HAL_FLASH_STR("ARQ TIMEOUT  "), stats.arqTimeouts);
+    printCounter(HAL_FLASH_STR("ARQ GIVE UP  "), stats.arqGiveUps);
+    printCounter(HAL_FLASH_STR("ARQ DUPLICATE"), stats.arqDuplicates);
+    printCounter(HAL_FLASH_STR("ARQ DROPPED  "), stats.arqDropped);
+#endif
+
+#if USE_L4
+    printCounter(HAL_FLASH_STR("L4 RESENT    "), stats.l4Retransmits);
+    printCounter(HAL_FLASH_STR("L4 TIMEOUT   "), stats.l4Timeouts);
+    printCounter(HAL_FLASH_STR("L4 DUPLICATE "), stats.l4Duplicates);
+#endif
+
+#if USE_FRAG
+    printCounter(HAL_FLASH_STR("FRAG DONE    "), stats.fragMessages);
+    printCounter(HAL_FLASH_STR("FRAG TIMEOUT "), stats.fragTimeouts);
+    printCounter(HAL_FLASH_STR("FRAG DROPPED "), stats.fragDropped);
+#endif
+
+#if USE_JUMBO
+    printCounter(HAL_FLASH_STR("JUMBO NEXT   "), jumboNext);
+    printCounter(HAL_FLASH_STR("JUMBO DROPPED"), stats.jumboDropped);
+#endif
+
+#if USE_AGG
+    printCounter(HAL_FLASH_STR("AGG FRAMES   "), stats.aggFrames);
+    printCounter(HAL_FLASH_STR("AGG RECORDS  "), stats.aggRecords);
+    printCounter(HAL_FLASH_STR("AGG DROPPED  "), stats.aggDropped);
+#endif
+
+#if USE_COMP
+    printCounter(HAL_FLASH_STR("COMP PACKED  "), stats.compPacked);
+    printCounter(HAL_FLASH_STR("COMP SKIPPED "), stats.compSkipped);
+    printCounter(HAL_FLASH_STR("COMP SAVED   "), stats.compSaved);
+    printCounter(HAL_FLASH_STR("COMP FAILED  "), stats.compFailed);
+#endif
+
+#if USE_TTL
+    printCounter(HAL_FLASH_STR("TTL EXPIRED  "), stats.ttlExpired);
+#endif
+
+#if USE_DEDUP
+    printCounter(HAL_FLASH_STR("BCAST DUPS   "), stats.dedupCaught);
+#endif
+
+#if USE_PHY2
+    printCounter(HAL_FLASH_STR("PHY2 CRC ERR "), stats.phy2CrcErrors);
+#endif
+
+#if USE_BRIDGE
+    printCounter(HAL_FLASH_STR("BR FORWARDED "), stats.bridgeForwarded);
+    printCounter(HAL_FLASH_STR("BR INJECTED  "), stats.bridgeInjected);
+    printCounter(HAL_FLASH_STR("BR RETURNED  "), stats.bridgeReturned);
+    printCounter(HAL_FLASH_STR("BR DROPPED   "), stats.bridgeDropped);
+#endif
+
+#if USE_DUAL
+    printCounter(HAL_FLASH_STR("DUAL REVERSE "), stats.dualReverse);
+    printCounter(HAL_FLASH_STR("DUAL DROPPED "), stats.dualDropped);
+#endif
+
+#if USE_QUEUE
+    printCounter(HAL_FLASH_STR("RELAY DROPS  "), stats.queueRelayDropped);
+    printCounter(HAL_FLASH_STR("RELAY AVG    "),
+                 stats.queueRelayFrames ? (stats.queueRelayWait / stats.queueRelayFrames) : 0);
+    printCounter(HAL_FLASH_STR("RELAY MAX    "), stats.queueRelayWaitMax);
+    printCounter(HAL_FLASH_STR("LOCAL AVG    "),
+                 stats.queueLocalFrames ? (stats.queueLocalWait / stats.queueLocalFrames) : 0);
+    printCounter(HAL_FLASH_STR("LOCAL MAX    "), stats.queueLocalWaitMax);
+#endif
+
+#if USE_FLOW
+    printCounter(HAL_FLASH_STR("FLOW PAUSES  "), stats.flowPauses);
+    printCounter(HAL_FLASH_STR("FLOW HELD    "), stats.flowHeld);
+#endif
+
+#if USE_TOKEN
+    printCounter(HAL_FLASH_STR("TOKEN VISITS "), stats.tokenVisits);
+    printCounter(HAL_FLASH_STR("TOKEN REGEN  "), stats.tokenRegenerated);
+    printCounter(HAL_FLASH_STR("TOKEN DUPS   "), stats.tokenDuplicates);
+#endif
+
+#if USE_TDMA
+    printCounter(HAL_FLASH_STR("SLOT MISSES  "), stats.tdmaMisses);
+    printCounter(HAL_FLASH_STR("SYNCS        "), stats.tdmaSyncs);
+    printCounter(HAL_FLASH_STR("SYNC ERROR   "), stats.tdmaSyncError);
+    printCounter(HAL_FLASH_STR("SYNC ERR MAX "), stats.tdmaSyncErrorMax);
+#endif
+}
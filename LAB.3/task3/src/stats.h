@@ -0,0 +1,99 @@
+#pragma once
+
+/// Link statistics - counted by the interrupt routines and printed by pressing 's', the counters of a feature
+/// only take RAM in builds that turn it on
+typedef struct
+{
+    uint32_t rxTimeouts;        ///< Partial frames aborted by the receive watchdog
+    uint32_t rxRecovery;        ///< Ticks from the last abort until the next valid frame
+    uint32_t rxRecoveryMax;     ///< Longest recovery observed so far
+    uint32_t rxOversize;        ///< Frames whose DLC exceeds the frame buffer
+#if !USE_QUEUE
+    uint32_t txCut;             ///< Frames cut off on the wire because a relay took the transmitter
+#endif
+#if USE_FEC
+    uint32_t fecCorrected;      ///< Codewords repaired by the Hamming decoder
+    uint32_t fecFailed;         ///< Codewords with an uncorrectable error
+#endif
+#if USE_ARQ
+    uint32_t arqRetransmits;    ///< Frames sent again after a NACK or a timeout
+    uint32_t arqNacks;          ///< NACKs received from the downstream neighbour
+    uint32_t arqTimeouts;       ///< Expiries of the retransmission timer
+    uint32_t arqGiveUps;        ///< Frames dropped after ARQ_RETRIES retransmissions
+    uint32_t arqDuplicates;     ///< Retransmitted frames that had already arrived
+    uint32_t arqDropped;        ///< Relays dropped because the window was full
+#endif
+#if USE_L4
+    uint32_t l4Retransmits;     ///< Segments sent again after their timer ran out
+    uint32_t l4Timeouts;        ///< Segments given up after L4_RETRIES attempts
+    uint32_t l4Duplicates;      ///< Segments that had already been delivered
+#endif
+#if USE_FRAG
+    uint32_t fragMessages;      ///< Messages reassembled completely
+    uint32_t fragTimeouts;      ///< Incomplete messages released by the reassembly timer
+    uint32_t fragDropped;       ///< Fragments without a buffer or out of order
+#endif
+#if USE_JUMBO
+    uint32_t jumboDropped;      ///< Frames too long for the downstream neighbour
+#endif
+#if USE_AGG
+    uint32_t aggFrames;         ///< Aggregated frames sent
+    uint32_t aggRecords;        ///< Records received in aggregated frames
+    uint32_t aggDropped;        ///< Records to be forwarded that found the frame full
+#endif
+#if USE_COMP
+    uint32_t compPacked;        ///< Payloads sent compressed
+    uint32_t compSkipped;       ///< Payloads sent as they are because they did not shrink
+    uint32_t compSaved;         ///< Bytes saved by the compression
+    uint32_t compFailed;        ///< Received payloads that could not be restored
+#endif
+#if USE_TTL
+    uint32_t ttlExpired;        ///< Frames dropped instead of relayed because their hop limit ran out
+#endif
+#if USE_DEDUP
+    uint32_t dedupCaught;       ///< Broadcasts dropped because the cache had seen them before
+#endif
+#if USE_PHY2
+    uint32_t phy2CrcErrors;     ///< Frames of the second port with a wrong crc
+#endif
+#if USE_BRIDGE
+    uint32_t bridgeForwarded;   ///< Frames handed from the first ring to the second
+    uint32_t bridgeInjected;    ///< Frames handed from the second ring to the first
+    uint32_t bridgeReturned;    ///< Bridged frames removed after going once around
+    uint32_t bridgeDropped;     ///< Frames lost because the other port was busy
+#endif
+#if USE_DUAL
+    uint32_t dualReverse;       ///< Frames sent on the second ring
+    uint32_t dualDropped;       ///< Frames of the second ring lost because its transmitter was busy
+#endif
+#if USE_QUEUE
+    uint32_t queueRelayDropped; ///< Frames to be relayed that found the relay queue full
+    uint32_t queueRelayFrames;  ///< Relayed frames and their time in the queue, in timer ticks
+    uint32_t queueRelayWait;
+    uint32_t queueRelayWaitMax;
+    uint32_t queueLocalFrames;  ///< Frames of this node and their time in the queue, in timer ticks
+    uint32_t queueLocalWait;
+    uint32_t queueLocalWaitMax;
+#endif
+#if USE_FLOW
+    uint32_t flowPauses;        ///< Times the ready line to the upstream node went low
+    uint32_t flowHeld;          ///< Polls that held a frame of this node back
+#endif
+#if USE_TOKEN
+    uint32_t tokenVisits;       ///< Times the token came to this node
+    uint32_t tokenRegenerated;  ///< Tokens created by this node after the token got lost
+    uint32_t tokenDuplicates;   ///< Tokens removed because this node already held one
+#endif
+#if USE_TDMA
+    uint32_t tdmaMisses;        ///< Own slots that ended while a frame of this node still waited
+    uint32_t tdmaSyncs;         ///< Sync frames applied
+    uint32_t tdmaSyncError;     ///< Clock error corrected by the last sync frame and the largest one, in ticks
+    uint32_t tdmaSyncErrorMax;
+#endif
+} stats_t;
+
+volatile stats_t stats;
+
+/*! \brief      Prints all link statistics on Minicom
+  * \return     void */
+void printStats();
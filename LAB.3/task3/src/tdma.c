@@ -0,0 +1,103 @@
+#pragma once
+#include "interrupt.h"
+#include "tdma.h"
+#include "calc.c"
+#include "layer3.c"
+#include "stats.c"
+#include "arq.c"
+
+#if USE_TDMA
+/// Phase of the cycle in ticks
+static uint16_t tdmaPhase()
+{
+    return (uint16_t)((tdmaSlot * TDMA_SLOT_TICKS) + tdmaSlotTick);
+}
+
+void tdmaTick(const uint8_t pending)
+{
+    if((++tdmaSlotTick) < TDMA_SLOT_TICKS)
+        return;
+
+    tdmaSlotTick = 0;
+    if((tdmaSlots[tdmaSlot] == MY_ID) && pending)
+        stats.tdmaMisses++;
+    if((++tdmaSlot) >= TDMA_SLOTS)
+    {
+        tdmaSlot = 0;
+        if(MY_ID == TDMA_MASTER_ID)
+            tdmaSyncDue = 1;
+    }
+}
+
+uint8_t tdmaMaySend(const frame_t* frame)
+{
+    uint16_t frameTicks = (8 + ((4 + DLC_SIZE + FRAME_LENGTH(frame)) * CODE_BITS)) * BIT_TICKS;
+    return ((tdmaSlots[tdmaSlot] == MY_ID) && ((TDMA_SLOT_TICKS - tdmaSlotTick) >= frameTicks));
+}
+
+void tdmaSync(frame_t* frame)
+{
+    if(!TDMA_IS_SYNC(frame) || (frame->payload[HDR_SRC] != TDMA_MASTER_ID))
+        return;
+
+    uint8_t hops = frame->payload[HDR_SIZE+4];
+    if(MY_ID == TDMA_MASTER_ID)
+    {
+        // Own sync frame back - the ring took (hops + 1) hop delays
+        tdmaHopDelay = (uint16_t)((ticks - tdmaSyncSent) / (hops + 1));
+        return;
+    }
+
+    uint16_t sent = ((frame->payload[HDR_SIZE+2] << 8) | frame->payload[HDR_SIZE+3]);
+    tdmaHopDelay = ((frame->payload[HDR_SIZE+5] << 8) | frame->payload[HDR_SIZE+6]);
+    uint16_t phase = (uint16_t)((sent + ((uint32_t)(hops + 1) * tdmaHopDelay)) % TDMA_CYCLE_TICKS);
+
+    // Error of the clock before the correction, folded into half a cycle either way
+    int32_t error = (int32_t)phase - (int32_t)tdmaPhase();
+    if(error > (TDMA_CYCLE_TICKS / 2))
+        error -= TDMA_CYCLE_TICKS;
+    else if(error < -(TDMA_CYCLE_TICKS / 2))
+        error += TDMA_CYCLE_TICKS;
+    stats.tdmaSyncs++;
+    stats.tdmaSyncError = (error < 0) ? -error : error;
+    if(stats.tdmaSyncError > stats.tdmaSyncErrorMax)
+        stats.tdmaSyncErrorMax = stats.tdmaSyncError;
+
+    tdmaSlot = (phase / TDMA_SLOT_TICKS);
+    tdmaSlotTick = (phase % TDMA_SLOT_TICKS);
+
+    frame->payload[HDR_SIZE+4] = hops + 1;
+    clearBuffer(frame->crc, 32);
+    makeCrc(frame->crc, frame->payload, FRAME_LENGTH(frame), _polynomial, GENERATE);
+}
+
+uint8_t tdmaPoll(frame_t* frame)
+{
+    if(!tdmaSyncDue)
+        return 0x00;
+
+    uint16_t phase = tdmaPhase();
+    clearFrame(frame);
+    SET_LENGTH(frame, (HDR_SIZE + TDMA_SYNC_SIZE));
+    frame->payload[HDR_DST] = BROADCAST_ID;
+    frame->payload[HDR_SRC] = MY_ID;
+    frame->payload[HDR_SIZE+0] = 'T';
+    frame->payload[HDR_SIZE+1] = 'S';
+    frame->payload[HDR_SIZE+2] = (phase >> 8);
+    frame->payload[HDR_SIZE+3] = (phase & 0xff);
+    frame->payload[HDR_SIZE+4] = 0;
+    frame->payload[HDR_SIZE+5] = (tdmaHopDelay >> 8);
+    frame->payload[HDR_SIZE+6] = (tdmaHopDelay & 0xff);
+#if USE_TTL
+    frame->payload[HDR_TTL] = ttlStart;
+#endif
+    makeCrc(frame->crc, frame->payload, FRAME_LENGTH(frame), _polynomial, GENERATE);
+#if USE_ARQ
+    if(!arqStamp(frame))
+        return 0x00;
+#endif
+    tdmaSyncDue = 0;
+    tdmaSyncSent = ticks;
+    return 0x01;
+}
+#endif
@@ -0,0 +1,90 @@
+#pragma once
+#include "config.h"
+#include "interrupt.h"
+#include "fec.h"
+#include "layer3.h"
+
+/* TDMA
+ * The cycle is split into TDMA_SLOTS slots of TDMA_SLOT_BITS, every slot belongs to one node ID.
+ * A node starts frames of its own only inside its slot, relayed frames always pass. A slot is
+ * long enough for a TDMA_FRAME_BYTES frame to go around the whole ring store-and-forward,
+ * so the frames of different slots never meet at a transmitter.
+ *
+ * Time Sync
+ * The owner of slot 0 is the master. It broadcasts its cycle phase at the start of every cycle,
+ * and every node adds one hop delay per relay the sync frame took. The master measures the hop
+ * delay from the time its own sync frame needs around the ring and sends it along. */
+
+/// Slots per cycle and the node that owns each of them - slot 0 also carries the time sync.
+/// The table has to be the same on every node, e.g. -DTDMA_SLOTS=4 -DTDMA_SLOT_IDS=1,2,3,4 for the ring emulator
+#ifndef TDMA_SLOTS
+#define TDMA_SLOTS              4
+#endif
+#ifndef TDMA_MASTER_ID
+#define TDMA_MASTER_ID          0x01
+#endif
+#ifndef TDMA_SLOT_IDS
+#define TDMA_SLOT_IDS           TDMA_MASTER_ID, 0x04, 0x09, 0x0f
+#endif
+
+/// Largest payload the slots are sized for, and the slot length in bit times with a guard of 16 bits.
+/// The phase travels as 16 bits, so a cycle has to stay below 65536 ticks
+#define TDMA_FRAME_BYTES        32
+#define TDMA_FRAME_BITS         (8 + ((4 + DLC_SIZE + TDMA_FRAME_BYTES) * CODE_BITS))
+#define TDMA_SLOT_BITS          ((RING_SIZE * TDMA_FRAME_BITS) + 16)
+#define TDMA_SLOT_TICKS         ((uint16_t)(TDMA_SLOT_BITS * BIT_TICKS))
+#define TDMA_CYCLE_TICKS        ((uint16_t)(TDMA_SLOTS * TDMA_SLOT_TICKS))
+
+#if USE_TDMA && ((TDMA_SLOTS * TDMA_SLOT_BITS * BIT_TICKS) > 65535)
+#error "TDMA cycle of 65536 ticks or more - fewer slots, a smaller ring or a lower TDMA_FRAME_BYTES"
+#endif
+
+/// Sync frame - "TS", phase of the master in ticks, relays so far and the hop delay in ticks
+#define TDMA_SYNC_SIZE          7
+#define TDMA_SYNC_BITS          (8 + ((4 + DLC_SIZE + HDR_SIZE + TDMA_SYNC_SIZE) * CODE_BITS))
+#define TDMA_IS_SYNC(frame)     ((FRAME_LENGTH(frame) == (HDR_SIZE + TDMA_SYNC_SIZE)) && \
+                                 ((frame)->payload[HDR_SIZE+0] == 'T') && ((frame)->payload[HDR_SIZE+1] == 'S'))
+
+#if USE_TDMA
+/// Slot table - node ID per slot
+const uint8_t tdmaSlots[TDMA_SLOTS] = { TDMA_SLOT_IDS };
+
+/// Current slot and the ticks spent in it
+volatile uint8_t tdmaSlot = 0;
+volatile uint16_t tdmaSlotTick = 0;
+
+/// Ticks per hop - the master measures it, everybody else learns it from the sync frame
+uint16_t tdmaHopDelay = (TDMA_SYNC_BITS * BIT_TICKS);
+
+/// Master - tick its last sync frame went out, and whether the next one is due
+uint32_t tdmaSyncSent = 0;
+volatile uint8_t tdmaSyncDue = 0;
+
+/// Set by sendFrame while a frame waits for the slot of this node
+volatile uint8_t tdmaPending = 0;
+#endif
+
+/*! \brief      Advances the slot clock, called on every timer tick
+  * \details    Counts a slot miss when the slot of this node ends while a frame of it still waits
+  * \param      pending - 1 if frames of this node wait for their slot
+  * \return     void */
+void tdmaTick(const uint8_t pending);
+
+
+/*! \brief      Tells whether a frame of this node may start now
+  * \param      frame   - Frame to be sent
+  * \return     unsigned 8-bits data - 1 inside the own slot if the frame ends before the slot does */
+uint8_t tdmaMaySend(const frame_t* frame);
+
+
+/*! \brief      Sets the slot clock from a received sync frame and counts the hop it is relayed on
+  * \details    The hop count changes, so the crc of the frame is generated again
+  * \param      frame   - Intact received frame, anything but a sync frame is left alone
+  * \return     void */
+void tdmaSync(frame_t* frame);
+
+
+/*! \brief      Sends the sync frame of the master at the start of a cycle
+  * \param      frame   - Transmit buffer
+  * \return     unsigned 8-bits data - 1 if the frame has been filled, else 0 */
+uint8_t tdmaPoll(frame_t* frame);
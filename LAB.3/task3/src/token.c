@@ -0,0 +1,53 @@
+#pragma once
+#include "interrupt.h"
+#include "token.h"
+#include "calc.c"
+#include "layer3.c"
+#include "stats.c"
+#include "arq.c"
+
+#if USE_TOKEN
+uint8_t tokenMaySend()
+{
+    return (tokenHeld && ((ticks - tokenSince) < (TOKEN_HOLD_BITS*BIT_TICKS)));
+}
+
+void tokenReceive(const frame_t* frame)
+{
+    tokenSeen = ticks;
+    if(tokenHeld)
+    {
+        // Two tokens after a regeneration - this one goes
+        stats.tokenDuplicates++;
+        return;
+    }
+    tokenHeld = 1;
+    tokenSince = ticks;
+    stats.tokenVisits++;
+}
+
+uint8_t tokenPoll(frame_t* frame, const uint8_t pending)
+{
+    if(!tokenHeld)
+    {
+        if((ticks - tokenSeen) <= (TOKEN_LOST_BITS*BIT_TICKS))
+            return 0x00;
+        stats.tokenRegenerated++;
+        tokenSeen = ticks;
+    }
+    else if(pending && tokenMaySend())
+        return 0x00;
+
+    clearFrame(frame);
+    SET_LENGTH(frame, HDR_SIZE);
+    frame->payload[HDR_DST] = TOKEN_ID;
+    frame->payload[HDR_SRC] = MY_ID;
+    makeCrc(frame->crc, frame->payload, FRAME_LENGTH(frame), _polynomial, GENERATE);
+#if USE_ARQ
+    if(!arqStamp(frame))
+        return 0x00;
+#endif
+    tokenHeld = 0;
+    return 0x01;
+}
+#endif
@@ -0,0 +1,61 @@
+#pragma once
+#include "config.h"
+
+/* Token MAC
+ * A node sends frames of its own only while it holds the token, relayed frames always pass.
+ * The holder passes the token on once it has nothing left to send or TOKEN_HOLD_BITS ran out.
+ *
+ * Bounded Access Latency
+ * Every holder sends for at most TOKEN_HOLD_BITS plus the rest of the frame it started last,
+ * then the token follows that frame node by node. Relays are store-and-forward, so the token
+ * can wait behind one longest frame on every other link as well. A node that wants to send
+ * therefore gets the token within TOKEN_ROTATION_BITS:
+ *
+ *      N * (TOKEN_HOLD_BITS + TOKEN_MAX_FRAME_BITS + TOKEN_FRAME_BITS) + (N-1) * TOKEN_MAX_FRAME_BITS
+ *
+ * which for N = 8 and plain legacy frames is 47800 bit times, about 147 s at 325.5 bit/s. */
+
+/// Link-local destination of the token frame
+#define TOKEN_ID                0xfe
+
+/// Bit times a holder may start frames of its own - one longest legacy frame by default
+#ifndef TOKEN_HOLD_BITS
+#define TOKEN_HOLD_BITS         2056UL
+#endif
+
+/// Bit times of the token frame and of the longest frame on the wire - unsigned long, the sums below pass 32767
+#define TOKEN_FRAME_BITS        (8UL + ((4 + DLC_SIZE + HDR_SIZE) * CODE_BITS))
+#define TOKEN_MAX_FRAME_BITS    (8UL + ((4 + DLC_SIZE + FRAME_PAYLOAD) * CODE_BITS))
+
+/// Worst-case time between two visits of the token
+#define TOKEN_ROTATION_BITS     ((RING_SIZE * (TOKEN_HOLD_BITS + TOKEN_MAX_FRAME_BITS + TOKEN_FRAME_BITS)) + ((RING_SIZE - 1) * TOKEN_MAX_FRAME_BITS))
+
+/// Bit times without the token before this node creates a new one - staggered by the ID, so the lowest ID wins
+#define TOKEN_LOST_BITS         (TOKEN_ROTATION_BITS + (MY_ID * TOKEN_FRAME_BITS))
+
+#if USE_TOKEN
+/// 1 while this node holds the token, the tick it came in and the tick it was last seen
+volatile uint8_t tokenHeld = 0;
+volatile uint32_t tokenSince = 0;
+volatile uint32_t tokenSeen = 0;
+
+/// Set by sendFrame while it waits for the token
+volatile uint8_t tokenWaiting = 0;
+#endif
+
+/*! \brief      Tells whether this node may start a frame of its own
+  * \return     unsigned 8-bits data - 1 while it holds the token and the holding time lasts */
+uint8_t tokenMaySend();
+
+
+/*! \brief      Takes the token off the ring
+  * \param      frame   - Received frame with TOKEN_ID as destination
+  * \return     void */
+void tokenReceive(const frame_t* frame);
+
+
+/*! \brief      Passes the token to the next node, or creates a new one once it got lost
+  * \param      frame   - Transmit buffer
+  * \param      pending - 1 if frames of this node wait for the token
+  * \return     unsigned 8-bits data - 1 if the token frame has been filled, else 0 */
+uint8_t tokenPoll(frame_t* frame, const uint8_t pending);
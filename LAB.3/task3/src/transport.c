@@ -0,0 +1,297 @@
+#pragma once
+#include "interrupt.h"
+#include "transport.h"
+#include "calc.c"
+#include "layer3.c"
+#include "stats.c"
+
+#if USE_L4
+void l4PrintMessage(const uint8_t addr, const uint8_t ports, const uint8_t* data, const uint8_t length)
+{
+    printMsg("PORT ", 5);
+    printNumber((ports & 0x0f));
+    printMsg(" FROM ", 6);
+    printNumber(addr);
+    printMsg(" : ", 3);
+    printMsg((const char*)data, length);
+    uart_changeLine();
+}
+
+void l4PrintTimeout(const uint8_t addr, const uint8_t ports, const uint8_t id)
+{
+    printMsg("TIMEOUT TO ", 11);
+    printNumber(addr);
+    printMsg(" ID ", 4);
+    printNumber(id);
+    uart_changeLine();
+}
+
+/// 1 if nothing is in flight or to be acknowledged and both halves have been quiet for long enough
+uint8_t l4Idle(const connection_t* c)
+{
+    if((c->txBase != c->txNext) || c->ackPending)
+        return 0x00;
+    if((ticks - c->txActive) <= (L4_IDLE_BITS*BIT_TICKS))
+        return 0x00;
+    if(c->rxEpoch == L4_NO_EPOCH)
+        return 0x01;
+    return ((ticks - c->rxActive) > (2*L4_IDLE_BITS*BIT_TICKS)) ? 0x01 : 0x00;
+}
+
+/// Looks up the connection to a remote port, or opens a new one in a free or idle slot if "open" is set
+connection_t* l4Connection(const uint8_t addr, const uint8_t ports, const uint8_t open)
+{
+    connection_t* free = 0;
+    for(uint8_t i=0; i<L4_CONNECTIONS; i++)
+    {
+        connection_t* c = &l4Connections[i];
+        if(c->used && (c->addr == addr) && (c->ports == ports))
+            return c;
+        if((!free) && ((!c->used) || l4Idle(c)))
+            free = c;
+    }
+
+    if(free && open)
+    {
+        for(uint8_t i=0; i<sizeof(connection_t); i++)
+            ((uint8_t*)free)[i] = 0;
+        free->used = 1;
+        free->addr = addr;
+        free->ports = ports;
+        free->txEpoch = (l4Epoch++ & 0x0f);
+        free->txActive = ticks;
+        free->rxEpoch = L4_NO_EPOCH;
+        return free;
+    }
+    return 0;
+}
+
+/// Fills the layer 3 and layer 4 header of an outgoing frame
+void l4Header(frame_t* frame, const uint8_t addr, const uint8_t ports, const uint8_t id, const uint8_t flags)
+{
+    clearFrame(frame);
+    frame->payload[HDR_DST] = addr;
+    frame->payload[HDR_SRC] = MY_ID;
+    frame->payload[L4_ID] = id;
+    frame->payload[L4_FLAGS] = flags;
+    frame->payload[L4_PORTS] = ports;
+}
+
+/// Releases an acknowledged slot and moves the window over every released slot
+void l4Release(connection_t* c, const uint8_t id)
+{
+    if(((uint8_t)(id - c->txBase)) >= ((uint8_t)(c->txNext - c->txBase)))
+        return;
+
+    c->txActive = ticks;
+    c->txWindow[(id % L4_WINDOW)].tries = 0;
+    while((c->txBase != c->txNext) && (c->txWindow[(c->txBase % L4_WINDOW)].tries == 0))
+        c->txBase++;
+}
+
+uint8_t l4Send(const uint8_t addr, const uint8_t ports, const uint8_t* data, const uint8_t length, const uint8_t flags)
+{
+    if(length > L4_SEGMENT_SIZE)
+        return 0x00;
+
+    // Built in the frame of the main loop, a frame_t on the stack does not fit next to the connections
+    frame_t* frame = myFrame;
+
+    // Datagrams and broadcasts are never acknowledged, so they need no connection
+    if((flags & L4_FLAG_DGRAM) || (addr == BROADCAST_ID))
+    {
+        l4Header(frame, addr, ports, 0, (flags | L4_FLAG_DGRAM));
+        for(uint8_t i=0; i<length; i++)
+            frame->payload[(L4_SIZE+i)] = data[i];
+        SET_LENGTH(frame, (L4_SIZE + length));
+        sendFrame(frame);
+        return 0x01;
+    }
+
+    // The window is shared with the receive interrupt, which releases acknowledged slots
+    HAL_IRQ_OFF();
+    connection_t* c = l4Connection(addr, ports, 1);
+    if((!c) || (((uint8_t)(c->txNext - c->txBase)) >= L4_WINDOW))
+    {
+        HAL_IRQ_ON();
+        return 0x00;
+    }
+
+    // The receiver may have freed its half after a quiet spell - a new epoch starts the numbers over
+    if((c->txBase == c->txNext) && ((ticks - c->txActive) > (L4_IDLE_BITS*BIT_TICKS)))
+    {
+        c->txEpoch = (l4Epoch++ & 0x0f);
+        c->txBase = 0;
+        c->txNext = 0;
+    }
+
+    uint8_t id = c->txNext;
+    segment_t* s = &c->txWindow[(id % L4_WINDOW)];
+    for(uint8_t i=0; i<length; i++)
+        s->data[i] = data[i];
+    s->length = length;
+    s->tries = 1;
+    s->sent = ticks;
+    c->txNext++;
+    c->txActive = ticks;
+
+    l4Header(frame, c->addr, c->ports, id, (c->txEpoch << 4));
+    HAL_IRQ_ON();
+    for(uint8_t i=0; i<length; i++)
+        frame->payload[(L4_SIZE+i)] = data[i];
+    SET_LENGTH(frame, (L4_SIZE + length));
+    sendFrame(frame);
+    return 0x01;
+}
+
+void l4Receive(const frame_t* frame)
+{
+    uint8_t addr = frame->payload[HDR_SRC];
+    uint8_t flags = frame->payload[L4_FLAGS];
+    uint8_t id = frame->payload[L4_ID];
+    uint8_t ports = frame->payload[L4_PORTS];
+
+    // The connection keeps the ports as seen from this node, the other way around
+    ports = ((ports << 4) | (ports >> 4));
+
+    // Broadcasts and datagrams are never acknowledged and take no connection
+    if((frame->payload[HDR_DST] == BROADCAST_ID) || (flags & L4_FLAG_DGRAM))
+    {
+        if(l4OnReceive)
+            l4OnReceive(addr, ports, &frame->payload[L4_SIZE], (FRAME_LENGTH(frame) - L4_SIZE));
+        return;
+    }
+
+    // Only data opens a connection, an ACK without one or of an earlier epoch is late
+    connection_t* c = l4Connection(addr, ports, !(flags & L4_FLAG_ACK));
+    if(!c)
+        return;
+
+    // Acknowledgement - everything up to "id" plus the selectively acknowledged segments after it
+    if(flags & L4_FLAG_ACK)
+    {
+        if(L4_EPOCH(flags) != c->txEpoch)
+            return;
+        while(((uint8_t)(id - c->txBase)) < ((uint8_t)(c->txNext - c->txBase)))
+            l4Release(c, c->txBase);
+
+        if(flags & L4_FLAG_SACK)
+        {
+            uint8_t mask = frame->payload[L4_SIZE];
+            for(uint8_t i=0; i<8; i++)
+            {
+                if(mask & (1 << i))
+                    l4Release(c, (id + 2 + i));
+            }
+        }
+        return;
+    }
+
+    // A new epoch of the sender starts the numbers over
+    if(L4_EPOCH(flags) != c->rxEpoch)
+    {
+        c->rxEpoch = L4_EPOCH(flags);
+        c->rxNext = 0;
+        c->rxMask = 0;
+    }
+    c->rxActive = ticks;
+
+    uint8_t offset = (id - c->rxNext);
+    uint8_t fresh = 0;
+
+    if(offset == 0)
+    {
+        // In order - moves over every segment that already arrived out of order
+        uint8_t have = 1;
+        while(have)
+        {
+            have = (c->rxMask & 0x01);
+            c->rxMask >>= 1;
+            c->rxNext++;
+        }
+        fresh = 1;
+    }
+    else if(offset <= 8)
+    {
+        if(!(c->rxMask & (1 << (offset-1))))
+        {
+            c->rxMask |= (1 << (offset-1));
+            fresh = 1;
+        }
+    }
+    else if(offset < 128)
+    {
+        // Too far ahead of the window - the sender retransmits it later
+        return;
+    }
+
+    if(!fresh)
+        stats.l4Duplicates++;
+    else if(l4OnReceive)
+        l4OnReceive(addr, ports, &frame->payload[L4_SIZE], (FRAME_LENGTH(frame) - L4_SIZE));
+    c->ackPending = 1;
+}
+
+void l4Poll()
+{
+    frame_t* frame = myFrame;
+
+    for(uint8_t i=0; i<L4_CONNECTIONS; i++)
+    {
+        connection_t* c = &l4Connections[i];
+
+        // Frees the slot for other peers once both halves have been quiet
+        HAL_IRQ_OFF();
+        if(c->used && l4Idle(c))
+            c->used = 0;
+        HAL_IRQ_ON();
+        if(!c->used)
+            continue;
+
+        // Cumulative and selective acknowledgement
+        if(c->ackPending)
+        {
+            HAL_IRQ_OFF();
+            l4Header(frame, c->addr, c->ports, (c->rxNext - 1), (L4_FLAG_ACK | L4_FLAG_SACK | (c->rxEpoch << 4)));
+            frame->payload[L4_SIZE] = c->rxMask;
+            c->ackPending = 0;
+            HAL_IRQ_ON();
+            SET_LENGTH(frame, (L4_SIZE + 1));
+            sendFrame(frame);
+        }
+
+        // Selective retransmission of the segments whose timer ran out
+        for(uint8_t id=c->txBase; id!=c->txNext; id++)
+        {
+            HAL_IRQ_OFF();
+            segment_t* s = &c->txWindow[(id % L4_WINDOW)];
+            if((s->tries == 0) || ((ticks - s->sent) <= (L4_TIMEOUT_BITS*BIT_TICKS)))
+            {
+                HAL_IRQ_ON();
+                continue;
+            }
+
+            if(s->tries >= L4_RETRIES)
+            {
+                l4Release(c, id);
+                HAL_IRQ_ON();
+                stats.l4Timeouts++;
+                if(l4OnTimeout)
+                    l4OnTimeout(c->addr, c->ports, id);
+                break;
+            }
+
+            s->tries++;
+            s->sent = ticks;
+            l4Header(frame, c->addr, c->ports, id, (c->txEpoch << 4));
+            for(uint8_t k=0; k<s->length; k++)
+                frame->payload[(L4_SIZE+k)] = s->data[k];
+            SET_LENGTH(frame, (L4_SIZE + s->length));
+            HAL_IRQ_ON();
+
+            stats.l4Retransmits++;
+            sendFrame(frame);
+        }
+    }
+}
+#endif
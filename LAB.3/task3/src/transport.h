@@ -0,0 +1,121 @@
+#pragma once
+#include "config.h"
+
+/// Layer 4 header - follows the layer 3 header
+#define L4_ID               (HDR_SIZE + 0)
+#define L4_FLAGS            (HDR_SIZE + 1)
+#define L4_PORTS            (HDR_SIZE + 2)
+#define L4_SIZE             (HDR_SIZE + 3)
+
+/// Layer 4 flags - ACK and DGRAM as in the RaspNet definition, SACK from the reserved bits
+#define L4_FLAG_ACK         0x01
+#define L4_FLAG_DGRAM       0x02
+#define L4_FLAG_SACK        0x04
+
+/// The high nibble of the flags carries the epoch of the sender's connection - identification numbers start
+/// at 0 in every epoch, so a receiver that sees a new one starts over and ACKs of an old one are ignored
+#define L4_EPOCH(flags)     ((flags) >> 4)
+#define L4_NO_EPOCH         0xff
+
+/// Ports are 4 bits each - destination port in the high nibble, source port in the low nibble
+#define L4_PORT_CONSOLE     1
+
+/// Segments in flight per connection, at most 8 so that one SACK byte covers the window
+#define L4_WINDOW           4
+
+/// Largest message kept for retransmission - every window slot of every connection costs this much RAM
+#define L4_SEGMENT_SIZE     32
+
+/// Peers a node talks to at the same time - a slot is freed once it has been idle, see L4_IDLE_BITS
+#define L4_CONNECTIONS      2
+
+/// Sending attempts before the application is told about a timeout
+#define L4_RETRIES          5
+
+/// Bit times to wait for an ACK - t = n * Wc(Layer 1) * 2 from the RaspNet definition,
+/// with 2040 bits as the worst case frame
+#define L4_TIMEOUT_BITS     (RING_SIZE * 2040UL * 2)
+
+/// Bit times with an empty window after which the next message starts a new epoch. The receiving half waits
+/// twice as long before its slot is freed, so the sender has always moved on to a new epoch by then.
+#define L4_IDLE_BITS        L4_TIMEOUT_BITS
+
+typedef struct
+{
+    uint8_t tries;                      ///< Sending attempts so far, 0 for a free slot
+    uint8_t length;
+    uint32_t sent;                      ///< Tick of the last attempt
+    uint8_t data[L4_SEGMENT_SIZE];
+} segment_t;
+
+typedef struct
+{
+    uint8_t used;
+    uint8_t addr;                       ///< Remote node
+    uint8_t ports;                      ///< Remote port in the high nibble, local port in the low nibble
+    uint8_t txBase;                     ///< Oldest identification number not acknowledged yet
+    uint8_t txNext;                     ///< Identification number of the next segment
+    uint8_t txEpoch;
+    uint32_t txActive;                  ///< Tick of the last segment sent or acknowledged
+    segment_t txWindow[L4_WINDOW];      ///< Indexed by identification number modulo L4_WINDOW
+    uint8_t rxNext;                     ///< Lowest identification number not received yet
+    uint8_t rxMask;                     ///< Bit i - "rxNext+1+i" has been received
+    uint8_t rxEpoch;                    ///< Epoch of the remote sender, L4_NO_EPOCH before its first segment
+    uint32_t rxActive;                  ///< Tick of the last segment received
+    uint8_t ackPending;
+} connection_t;
+
+#if USE_L4
+connection_t l4Connections[L4_CONNECTIONS];
+
+/// Epoch of the next connection this node sends on
+uint8_t l4Epoch = 0;
+#endif
+
+/*! \brief      Application callback for every new message, none if 0
+  * \details    Runs inside the pin-change interrupt of the receiver (PCINT2) - keep it short, and never call
+  *             l4Send or sendFrame from it, they wait for the transmitter that only the main loop frees.
+  *             "ports" holds the remote port in the high nibble and the local port in the low nibble. */
+void (*l4OnReceive)(const uint8_t addr, const uint8_t ports, const uint8_t* data, const uint8_t length);
+
+/*! \brief      Application callback for a message given up after L4_RETRIES attempts, none if 0
+  * \details    Runs in the main loop from l4Poll */
+void (*l4OnTimeout)(const uint8_t addr, const uint8_t ports, const uint8_t id);
+
+
+/*! \brief      Default l4OnReceive - prints the local port, the sender and the message on Minicom
+  * \return     void */
+void l4PrintMessage(const uint8_t addr, const uint8_t ports, const uint8_t* data, const uint8_t length);
+
+
+/*! \brief      Default l4OnTimeout - prints the peer and the identification number on Minicom
+  * \return     void */
+void l4PrintTimeout(const uint8_t addr, const uint8_t ports, const uint8_t id);
+
+
+/*! \brief      Sends a message to a port of another node
+  * \details    Reliable messages stay in the window until they are acknowledged, DGRAM messages and broadcasts
+  *             are sent once and take no connection. Waits for the transmitter like sendFrame - must not be called
+  *             from an interrupt routine. The segment is built in myFrame, which the console fills again before
+  *             every message.
+  * \param      addr    - Destination node
+  * \param      ports   - Destination port in the high nibble, source port in the low nibble
+  * \param      data    - Message
+  * \param      length  - Size of the message, at most L4_SEGMENT_SIZE
+  * \param      flags   - 0 or L4_FLAG_DGRAM
+  * \return     unsigned 8-bits data - 1 if sent, 0 if the window is full or no connection is free */
+uint8_t l4Send(const uint8_t addr, const uint8_t ports, const uint8_t* data, const uint8_t length, const uint8_t flags);
+
+
+/*! \brief      Runs the layer 4 part of a frame addressed to this node or to everybody
+  * \details    Called from the receive interrupt after layer 3
+  * \param      frame   - Received frame
+  * \return     void */
+void l4Receive(const frame_t* frame);
+
+
+/*! \brief      Sends pending ACKs and retransmits every segment whose timer ran out
+  * \details    Called from the main loop, also frees the connections that have been idle. Builds its frames in
+  *             myFrame like l4Send.
+  * \return     void */
+void l4Poll();
@@ -25,6 +25,11 @@ unsigned char uart_receive()
 	return UDR0;
 }
 
+uint8_t uart_available()
+{
+	return (UCSR0A & (1 << RXC0)) ? 0x01 : 0x00;
+}
+
 void uart_changeLine()
 {
     uart_transmit('\n');
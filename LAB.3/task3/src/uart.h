@@ -1,10 +1,5 @@
 #pragma once
-#include <avr/io.h>
-#define F_CPU 12000000UL
-#define BAUD 19200UL
-#define MYUBRR (F_CPU/(16*BAUD)-1)
-#include <util/setbaud.h>
-#include <util/delay.h>
+#include "hal.h"
 
 
 /*! \brief  Setup for the uart serial communication
@@ -24,6 +19,11 @@ void uart_transmit(unsigned char data);
 unsigned char uart_receive();
 
 
+/*! \brief  Checks whether a user-typed character is waiting, without blocking
+  * \return unsigned 8-bits data - 1(true) or 0(false) */
+uint8_t uart_available();
+
+
 /*! \brief  Changes to the new line
   * \return void */
 void uart_changeLine();